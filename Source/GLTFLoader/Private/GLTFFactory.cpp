@@ -24,6 +24,7 @@ UGLTFFactory::UGLTFFactory(const FObjectInitializer& ObjectInitializer)
 {
 	SupportedClass = UStaticMesh::StaticClass();
 	Formats.Add(TEXT("gltf;GLTF meshes"));
+	Formats.Add(TEXT("glb;GLTF binary meshes"));
 
 	bCreateNew = false;
 	bText = false;
@@ -56,9 +57,16 @@ UObject* UGLTFFactory::FactoryCreateBinary
 
 	FEditorDelegates::OnAssetPreImport.Broadcast(this, Class, InParent, Name, Type);
 
+	// Files imported together often share buffers and textures, so let them share the loaded copies until CleanUp()
+	if (!ImportBatch.IsValid())
+	{
+		ImportBatch = MakeShareable(new GLTFMeshBuilder::FScopedImportBatch);
+	}
+
 	UObject* NewObject = NULL;
 
-	GLTFMeshBuilder Builder(*UFactory::CurrentFilename);
+	// Load from the file contents the engine has already read rather than opening the file again
+	GLTFMeshBuilder Builder(*UFactory::CurrentFilename, Buffer, BufferEnd);
 
 	bool bShowImportDialog = bShowOption && !GIsAutomationTesting;
 	bool bImportAll = false;
@@ -179,11 +187,18 @@ bool UGLTFFactory::FactoryCanImport(const FString& Filename)
 {
 	const FString Extension = FPaths::GetExtension(Filename);
 
-	if (Extension == TEXT("gltf"))
+	if (Extension == TEXT("gltf") || Extension == TEXT("glb"))
 	{
 		return true;
 	}
 	return false;
 }
 
+void UGLTFFactory::CleanUp()
+{
+	ImportBatch.Reset();
+
+	Super::CleanUp();
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Factories/Factory.h"
+#include "GLTFMeshBuilder.h"
 #include "GLTFFactory.generated.h"
 
 UCLASS()
@@ -18,6 +19,7 @@ class UGLTFFactory : public UFactory
 	virtual bool DoesSupportClass(UClass * Class) override;
 	virtual UObject* FactoryCreateBinary(UClass* InClass, UObject* InParent, FName InName, EObjectFlags Flags, UObject* Context, const TCHAR* Type, const uint8*& Buffer, const uint8* BufferEnd, FFeedbackContext* Warn, bool& bOutOperationCanceled) override;
 	virtual bool FactoryCanImport(const FString& Filename) override;
+	virtual void CleanUp() override;
 	///@}
 
 	bool bShowOption;
@@ -25,5 +27,8 @@ class UGLTFFactory : public UFactory
 
 	/** true if the import operation was canceled. */
 	bool bOperationCanceled;
+
+	/// Lets the files of one import batch share external resources. Started by the first file and released in CleanUp().
+	TSharedPtr<GLTFMeshBuilder::FScopedImportBatch> ImportBatch;
 	
 };
@@ -11,6 +11,7 @@
 #include "GLTFLoaderStyle.h"
 #include "GLTFLoaderCommands.h"
 #include "GLTFFactory.h"
+#include "GLTFMeshBuilder.h"
 
 #include "LevelEditor.h"
 
@@ -210,6 +211,31 @@ TSharedRef<SDockTab> FGLTFLoaderModule::OnSpawnPluginTab(const FSpawnTabArgs& Sp
 					]
 				]
 			]
+			+ SVerticalBox::Slot()
+			.Padding(1.0f)
+			.HAlign(HAlign_Center)
+			[
+				SNew(SBox)
+				.HAlign(HAlign_Center)
+				.VAlign(VAlign_Center)
+				[
+					SNew(SButton)
+					.OnClicked_Raw(this, &FGLTFLoaderModule::PreviewFileDelegateFunc)
+					.Content()
+					[
+						SNew(STextBlock)
+						.Text(LOCTEXT("PreviewFile", "Preview File"))
+					]
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(1.0f)
+			.HAlign(HAlign_Center)
+			.VAlign(VAlign_Top)
+			[
+				SNew(STextBlock)
+				.Text_Raw(this, &FGLTFLoaderModule::GetPreviewText)
+			]
 		];
 
 }
@@ -222,7 +248,7 @@ void FGLTFLoaderModule::OpenImportWindow()
 		TEXT("Choose a GLTF file to import"),
 		TEXT(""),
 		TEXT(""),
-		TEXT("GL Transmission Format files (*.gltf)|*.gltf"),
+		TEXT("GL Transmission Format files (*.gltf;*.glb)|*.gltf;*.glb"),
 		EFileDialogFlags::None,
 		Filenames))
 	{
@@ -232,11 +258,50 @@ void FGLTFLoaderModule::OpenImportWindow()
 		}
 
 		FAssetToolsModule& AssetToolsModule = FModuleManager::Get().LoadModuleChecked<FAssetToolsModule>("AssetTools");
-
 		AssetToolsModule.Get().ImportAssets(Filenames, FString("/Game/Content"));
 	}
 }
 
+FReply FGLTFLoaderModule::PreviewFileDelegateFunc()
+{
+	TArray<FString> Filenames;
+
+	if (FDesktopPlatformModule::Get()->OpenFileDialog(nullptr,
+		TEXT("Choose a GLTF file to preview"),
+		TEXT(""),
+		TEXT(""),
+		TEXT("GL Transmission Format files (*.gltf;*.glb)|*.gltf;*.glb"),
+		EFileDialogFlags::None,
+		Filenames) && Filenames.Num() > 0)
+	{
+		// Only the file's structure is read, so this stays quick regardless of how much geometry it holds
+		GLTFMeshBuilder::FSceneSummary Summary;
+		FString Error;
+		FFormatOrderedArguments Args;
+		Args.Add(FText::FromString(FPaths::GetCleanFilename(Filenames[0])));
+		if (GLTFMeshBuilder::ScanFile(Filenames[0], Summary, Error))
+		{
+			Args.Add(FText::AsNumber(Summary.Meshes));
+			Args.Add(FText::AsNumber(Summary.Primitives));
+			Args.Add(FText::AsNumber(Summary.Nodes));
+			Args.Add(FText::AsNumber(Summary.Materials));
+			Args.Add(FText::AsNumber(Summary.Textures));
+			Args.Add(FText::AsNumber(Summary.Images));
+			Args.Add(FText::AsNumber(Summary.Triangles));
+			Args.Add(FText::AsMemory((uint64)Summary.AccessorBytes));
+			Args.Add(FText::AsMemory((uint64)Summary.BufferBytes));
+			PreviewText = FText::Format(LOCTEXT("PreviewSummary", "{0}\n{1} meshes ({2} primitives), {3} nodes\n{4} materials, {5} textures, {6} images\n~{7} triangles, {8} of vertex and index data in {9} of buffers"), Args);
+		}
+		else
+		{
+			Args.Add(FText::FromString(Error));
+			PreviewText = FText::Format(LOCTEXT("PreviewFailed", "{0} could not be read:\n{1}"), Args);
+		}
+	}
+
+	return FReply::Handled();
+}
+
 void FGLTFLoaderModule::PluginButtonClicked()
 {
 	FGlobalTabmanager::Get()->InvokeTab(GLTFLoaderTabName);
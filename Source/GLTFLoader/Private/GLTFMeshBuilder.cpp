@@ -25,6 +25,7 @@
 #include "Developer/MeshUtilities/Public/MeshUtilities.h"
 
 #include "Engine.h"
+#include "ParallelFor.h"
 #include "StaticMeshResources.h"
 #include "TextureLayout.h"
 #include "ObjectTools.h"
@@ -52,6 +53,14 @@ template<> struct GLTFType <TINYGLTF_COMPONENT_TYPE_DOUBLE>			{ typedef double
 template<> struct GLTFType <TINYGLTF_TYPE_VEC2>						{ typedef FVector2D Type; };
 template<> struct GLTFType <TINYGLTF_TYPE_VEC3>						{ typedef FVector   Type; };
 template<> struct GLTFType <TINYGLTF_TYPE_VEC4>						{ typedef FVector4  Type; };
+
+// Whether an element of DstType has the same bytes as its components of SrcType stored one after another, so that packed data can be copied as-is
+template<typename SrcType, typename DstType> struct GLTFPackedCopy	{ enum { Value = TAreTypesEqual<SrcType, DstType>::Value }; };
+template<> struct GLTFPackedCopy <uint32, int32>					{ enum { Value = true }; };
+template<> struct GLTFPackedCopy <int32, uint32>					{ enum { Value = true }; };
+template<> struct GLTFPackedCopy <float, FVector2D>					{ enum { Value = sizeof(FVector2D) == 2 * sizeof(float) }; };
+template<> struct GLTFPackedCopy <float, FVector>					{ enum { Value = sizeof(FVector)   == 3 * sizeof(float) }; };
+template<> struct GLTFPackedCopy <float, FVector4>					{ enum { Value = sizeof(FVector4)  == 4 * sizeof(float) }; };
 /// @endcond
 
 template <typename T>
@@ -69,14 +78,14 @@ bool GLTFMeshBuilder::ConvertAttrib(TArray<T> &OutArray, tinygltf::Mesh* Mesh, s
 		int32 Size = 0;
 		if (UseWedgeIndices)																
 		{																					
-			for (auto Prim : Mesh->primitives)												
+			for (auto &Prim : Mesh->primitives)												
 			{																				
 				Size += GetNumWedges(&Prim); // Number of wedges				
 			}
 		}																					
 		else																				
 		{																					
-			for (auto Prim : Mesh->primitives)												
+			for (auto &Prim : Mesh->primitives)												
 			{																				
 				Size += Scene->accessors[Prim.attributes.begin()->second].count; // Number of vertices		
 			}																				
@@ -88,14 +97,13 @@ bool GLTFMeshBuilder::ConvertAttrib(TArray<T> &OutArray, tinygltf::Mesh* Mesh, s
 	// Getting an attribute for individual triangle corners ("wedges")
 	else if (UseWedgeIndices && AttribName != "__WedgeIndices")// Make sure we don't try to access indices for the index array itself!
 	{
-		for (auto Prim : Mesh->primitives)
+		for (auto &Prim : Mesh->primitives)
 		{
-			std::string IndexAccessorName = Prim.indices;
-			std::string AttribAccessorName = Prim.attributes[AttribName];
-			tinygltf::Accessor* IndexAccessor = &Scene->accessors[IndexAccessorName];
-			tinygltf::Accessor* AttribAccessor = &Scene->accessors[AttribAccessorName];
+			auto Attrib = Prim.attributes.find(AttribName);
+			const TArray<int32>* WedgeIndices = GetCachedWedgeIndices(&Prim);
+			const tinygltf::AccessorView* AttribAccessor = Attrib != Prim.attributes.end() ? GetAccessorView(Attrib->second) : NULL;
 
-			if (!IndexAccessor || !AttribAccessor)
+			if (!WedgeIndices || !AttribAccessor)
 			{
 				AddTokenizedErrorMessage(
 					FTokenizedMessage::Create(
@@ -105,70 +113,39 @@ bool GLTFMeshBuilder::ConvertAttrib(TArray<T> &OutArray, tinygltf::Mesh* Mesh, s
 				return false;
 			}
 
-			TArray<int32> IndexArray;
 			TArray<T> VertArray;
 
-			if (!GetBufferData(IndexArray, IndexAccessor) || !GetBufferData(VertArray, AttribAccessor))
+			if (!GetBufferData(VertArray, AttribAccessor))
 			{
 				return false;
 			}
 
-			switch (Prim.mode)
+			OutArray.Reserve(OutArray.Num() + WedgeIndices->Num());
+			for (auto Index : *WedgeIndices)
 			{
-				case TINYGLTF_MODE_TRIANGLES:
-					for (auto Index : IndexArray)
-					{
-						OutArray.Add(VertArray[Index]);
-					}
-					break;
-
-				case TINYGLTF_MODE_TRIANGLE_STRIP:
-					OutArray.Add(VertArray[IndexArray[0]]);
-					OutArray.Add(VertArray[IndexArray[1]]);
-					OutArray.Add(VertArray[IndexArray[2]]);
-					for (int i = 2; i < IndexAccessor->count - 2; i += 2)
-					{
-						// First triangle
-						OutArray.Add(VertArray[IndexArray[ i ]]);
-						OutArray.Add(VertArray[IndexArray[i-1]]);
-						OutArray.Add(VertArray[IndexArray[i+1]]);
-						// Second triangle
-						OutArray.Add(VertArray[IndexArray[ i ]]);
-						OutArray.Add(VertArray[IndexArray[i+1]]);
-						OutArray.Add(VertArray[IndexArray[i+2]]);
-					}
-					break;
-
-				case TINYGLTF_MODE_TRIANGLE_FAN:
-					for (int i = 1; i < IndexAccessor->count - 1; ++i)
-					{
-						// Triangle
-						OutArray.Add(VertArray[IndexArray[ 0 ]]);
-						OutArray.Add(VertArray[IndexArray[ i ]]);
-						OutArray.Add(VertArray[IndexArray[i+1]]);
-					}
-					break;
-
-				default:
-					return false;
+				OutArray.Add(VertArray[Index]);
 			}
 		}
 	}
 	// Getting a vertex attribute
 	else
 	{
-		for (auto Prim : Mesh->primitives)
+		for (auto &Prim : Mesh->primitives)
 		{
-			std::string AccessorName;
+			int32 AccessorHandle = -1;
 			if (AttribName == "__WedgeIndices")
 			{
-				AccessorName = Prim.indices;
+				AccessorHandle = Prim.indices;
 			}
 			else
 			{
-				AccessorName = Prim.attributes[AttribName];
+				auto Attrib = Prim.attributes.find(AttribName);
+				if (Attrib != Prim.attributes.end())
+				{
+					AccessorHandle = Attrib->second;
+				}
 			}
-			if (!GetBufferData(OutArray, &Scene->accessors[AccessorName], true))
+			if (!GetBufferData(OutArray, GetAccessorView(AccessorHandle), true))
 			{
 				return false;
 			}
@@ -179,11 +156,11 @@ bool GLTFMeshBuilder::ConvertAttrib(TArray<T> &OutArray, tinygltf::Mesh* Mesh, s
 
 // Retrieve a value from the buffer, implicitly accounting for endianness
 // Adapted from http://stackoverflow.com/questions/13001183/how-to-read-little-endian-integers-from-file-in-c
-template <typename T> T GLTFMeshBuilder::BufferValue(void* Data/*, uint8 Size*/)
+template <typename T> T GLTFMeshBuilder::BufferValue(const void* Data/*, uint8 Size*/)
 {
 	T Ret = T(0);
 
-	auto NewData = reinterpret_cast<unsigned char*>(Data);
+	auto NewData = reinterpret_cast<const unsigned char*>(Data);
 	for (int i = 0; i < sizeof(T); ++i)
 	{
 		Ret |= (T)(NewData[i]) << (8 * i);
@@ -192,7 +169,7 @@ template <typename T> T GLTFMeshBuilder::BufferValue(void* Data/*, uint8 Size*/)
 }
 
 // Use unions for floats and doubles since they don't have a bitwise OR operator
-template <> float GLTFMeshBuilder::BufferValue(void* Data)
+template <> float GLTFMeshBuilder::BufferValue(const void* Data)
 {
 	assert(sizeof(float) == sizeof(int32));
 
@@ -204,7 +181,7 @@ template <> float GLTFMeshBuilder::BufferValue(void* Data)
 
 	Ret = 0.0f;
 
-	auto NewData = reinterpret_cast<unsigned char*>(Data);
+	auto NewData = reinterpret_cast<const unsigned char*>(Data);
 	for (int i = 0; i < sizeof(int32); ++i)
 	{
 		IntRet |= (int32)(NewData[i]) << (8 * i);
@@ -212,7 +189,7 @@ template <> float GLTFMeshBuilder::BufferValue(void* Data)
 	return Ret;
 }
 
-template <> double GLTFMeshBuilder::BufferValue(void* Data)
+template <> double GLTFMeshBuilder::BufferValue(const void* Data)
 {
 	assert(sizeof(float) == sizeof(int64));
 
@@ -224,7 +201,7 @@ template <> double GLTFMeshBuilder::BufferValue(void* Data)
 
 	Ret = 0.0;
 
-	auto NewData = reinterpret_cast<unsigned char*>(Data);
+	auto NewData = reinterpret_cast<const unsigned char*>(Data);
 	for (int i = 0; i < sizeof(int64); ++i)
 	{
 		IntRet |= (int64)(NewData[i]) << (8 * i);
@@ -240,16 +217,92 @@ struct MaterialPair
 };
 /// @endcond
 
+/// The resource cache of the current import batch, if any, and the number of open FScopedImportBatch instances.
+static std::shared_ptr<tinygltf::ResourceCache> ImportBatchCache;
+static int32 ImportBatchDepth = 0;
+
+GLTFMeshBuilder::FScopedImportBatch::FScopedImportBatch()
+{
+	if (ImportBatchDepth++ == 0)
+	{
+		ImportBatchCache = std::make_shared<tinygltf::ResourceCache>();
+	}
+}
+
+GLTFMeshBuilder::FScopedImportBatch::~FScopedImportBatch()
+{
+	if (--ImportBatchDepth == 0)
+	{
+		ImportBatchCache.reset();
+	}
+}
+
+bool GLTFMeshBuilder::ScanFile(const FString& FilePath, FSceneSummary& OutSummary, FString& OutError)
+{
+	tinygltf::TinyGLTFLoader ScanLoader;
+	tinygltf::SceneSummary Summary;
+	std::string TempError;
+	if (!ScanLoader.ScanFromFile(Summary, TempError, ToStdString(FilePath)))
+	{
+		OutError = ToFString(TempError);
+		return false;
+	}
+
+	OutSummary.Meshes			= (int32)Summary.meshes;
+	OutSummary.Primitives		= (int32)Summary.primitives;
+	OutSummary.Nodes			= (int32)Summary.nodes;
+	OutSummary.Materials		= (int32)Summary.materials;
+	OutSummary.Textures			= (int32)Summary.textures;
+	OutSummary.Images			= (int32)Summary.images;
+	OutSummary.Triangles		= (int64)Summary.triangles;
+	OutSummary.AccessorBytes	= (int64)Summary.accessorBytes;
+	OutSummary.BufferBytes		= (int64)Summary.bufferBytes;
+	return true;
+}
+
 GLTFMeshBuilder::GLTFMeshBuilder(FString FilePath)
 {
-	Loader = new tinygltf::TinyGLTFLoader;
-	Scene = new tinygltf::Scene;
+	CreateLoader();
 
 	std::string TempError;
 	LoadSuccess = Loader->LoadFromFile((*Scene), TempError, ToStdString(FilePath));
 	Error = ToFString(TempError);
 }
 
+GLTFMeshBuilder::GLTFMeshBuilder(FString FilePath, const uint8* Buffer, const uint8* BufferEnd)
+{
+	CreateLoader();
+
+	std::string TempError;
+	std::string BaseDir = ToStdString(FPaths::GetPath(FilePath));
+	unsigned int Length = (unsigned int)(BufferEnd - Buffer);
+	if (tinygltf::TinyGLTFLoader::IsBinary(Buffer, Length))
+	{
+		// The binary body is used in place, which is safe since the factory's buffer outlives this builder
+		LoadSuccess = Loader->LoadBinaryFromMemory((*Scene), TempError, Buffer, Length, BaseDir);
+	}
+	else
+	{
+		LoadSuccess = Loader->LoadFromString((*Scene), TempError, reinterpret_cast<const char*>(Buffer), Length, BaseDir);
+	}
+	Error = ToFString(TempError);
+}
+
+void GLTFMeshBuilder::CreateLoader()
+{
+	Loader = new tinygltf::TinyGLTFLoader;
+	Scene = new tinygltf::Scene;
+
+	// Run the loader's parallel stages (e.g. image decoding) on the task graph instead of its own threads
+	Loader->SetParallelFor([](size_t Count, const std::function<void(size_t)>& Task)
+	{
+		ParallelFor((int32)Count, [&Task](int32 Index) { Task((size_t)Index); });
+	});
+
+	// Share external resources with the other files of the current import batch
+	Loader->SetResourceCache(ImportBatchCache);
+}
+
 GLTFMeshBuilder::~GLTFMeshBuilder()
 {
 	delete Loader;
@@ -258,25 +311,28 @@ GLTFMeshBuilder::~GLTFMeshBuilder()
 
 int32 GLTFMeshBuilder::GetMeshCount(FString NodeName)
 {
-	return (int32)Scene->nodes[ToStdString(NodeName)].meshes.size();
+	int32 NodeHandle = Scene->nodes.find(ToStdString(NodeName));
+	return NodeHandle >= 0 ? (int32)Scene->nodes[NodeHandle].meshes.size() : 0;
 }
 
 FString GLTFMeshBuilder::GetRootNode()
 {
-	for (auto ThisNode : Scene->nodes)
+	// Mark every node which appears in some node's list of children
+	TArray<bool> IsChild;
+	IsChild.Init(false, (int32)Scene->nodes.size());
+	for (auto &Node : Scene->nodes)
 	{
-		bool ShouldReturn = false;
-		for (auto ThatNode : Scene->nodes)
+		for (int32 Child : Node.children)
 		{
-			if (FindInStdVector<std::string>(ThatNode.second.children, ThisNode.first) == -1) // If this node's name doesn't appear in any node's list of children
-			{
-				ShouldReturn = true;
-			}
+			IsChild[Child] = true;
 		}
+	}
 
-		if (ShouldReturn)
+	for (int32 NodeHandle = 0; NodeHandle < IsChild.Num(); ++NodeHandle)
+	{
+		if (!IsChild[NodeHandle])
 		{
-			return ToFString(ThisNode.first);
+			return ToFString(Scene->nodes.name(NodeHandle));
 		}
 	}
 	return FString("");
@@ -286,11 +342,11 @@ tinygltf::Node* GLTFMeshBuilder::GetMeshParentNode(tinygltf::Mesh* InMesh)
 {
 	for (auto &Node : Scene->nodes)
 	{
-		for (auto &MeshName : Node.second.meshes)
+		for (int32 MeshHandle : Node.meshes)
 		{
-			if (&Scene->meshes[MeshName] == InMesh)
+			if (&Scene->meshes[MeshHandle] == InMesh)
 			{
-				return &Node.second;
+				return &Node;
 			}
 		}
 	}
@@ -301,16 +357,22 @@ TArray<FString> GLTFMeshBuilder::GetMeshNames(FString NodeName, bool GetChildren
 {
 	TArray<FString> MeshNameArray;
 
-	for (auto Mesh : Scene->nodes[ToStdString(NodeName)].meshes)
+	int32 NodeHandle = Scene->nodes.find(ToStdString(NodeName));
+	if (NodeHandle < 0)
+	{
+		return MeshNameArray;
+	}
+
+	for (int32 MeshHandle : Scene->nodes[NodeHandle].meshes)
 	{
-		MeshNameArray.Add(ToFString(Mesh));
+		MeshNameArray.Add(ToFString(Scene->meshes.name(MeshHandle)));
 	}
 
 	if (GetChildren)
 	{
-		for (auto ChildName : Scene->nodes[ToStdString(NodeName)].children)
+		for (int32 ChildHandle : Scene->nodes[NodeHandle].children)
 		{
-			MeshNameArray.Append(GetMeshNames(ToFString(ChildName)));
+			MeshNameArray.Append(GetMeshNames(ToFString(Scene->nodes.name(ChildHandle))));
 		}
 	}
 
@@ -430,30 +492,31 @@ UStaticMesh* GLTFMeshBuilder::ImportStaticMeshAsSingle(UObject* InParent, TArray
 	FRawMesh NewRawMesh;
 	SrcModel.RawMeshBulkData->LoadRawMesh(NewRawMesh);
 
-	for (auto Name : MeshNameArray)
+	// Resolve the names once; everything below works on handles
+	TArray<tinygltf::Mesh*> Meshes;
+	for (auto &Name : MeshNameArray)
 	{
-		tinygltf::Mesh* Mesh = &Scene->meshes[ToStdString(Name)];
-
-		if (Mesh)
+		int32 MeshHandle = Scene->meshes.find(ToStdString(Name));
+		if (MeshHandle >= 0)
 		{
-			for (auto Prim : Mesh->primitives)
-			{
-				MeshMaterials.AddUnique(ToFString(Prim.material));
-			}
+			Meshes.Add(&Scene->meshes[MeshHandle]);
 		}
 	}
 
-	for (auto Name : MeshNameArray)
+	for (auto Mesh : Meshes)
 	{
-		tinygltf::Mesh* Mesh = &Scene->meshes[ToStdString(Name)];
+		for (auto &Prim : Mesh->primitives)
+		{
+			MeshMaterials.AddUnique(Prim.material);
+		}
+	}
 
-		if (Mesh)
+	for (auto Mesh : Meshes)
+	{
+		if (!BuildStaticMeshFromGeometry(Mesh, StaticMesh, LODIndex, NewRawMesh))
 		{
-			if (!BuildStaticMeshFromGeometry(Mesh, StaticMesh, LODIndex, NewRawMesh))
-			{
-				bBuildStatus = false;
-				break;
-			}
+			bBuildStatus = false;
+			break;
 		}
 	}
 
@@ -484,7 +547,7 @@ UStaticMesh* GLTFMeshBuilder::ImportStaticMeshAsSingle(UObject* InParent, TArray
 			}
 			if (bUnique)
 			{
-				int32 UniqueIndex = UniqueMaterials.Add(&Scene->materials[ToStdString(MeshMaterials[MaterialIndex])]);
+				int32 UniqueIndex = UniqueMaterials.Add(GetMaterial(MeshMaterials[MaterialIndex]));
 
 				MaterialMap.Add( UniqueIndex );
 			}
@@ -509,7 +572,7 @@ UStaticMesh* GLTFMeshBuilder::ImportStaticMeshAsSingle(UObject* InParent, TArray
 			int32 RemappedIndex = MaterialMap[MaterialIndex];
 			if (!SortedMaterialIndex.IsValidIndex(RemappedIndex))
 			{
-				FString GLTFMatName = MeshMaterials[RemappedIndex];
+				FString GLTFMatName = MeshMaterials[RemappedIndex] >= 0 ? ToFString(Scene->materials.name(MeshMaterials[RemappedIndex])) : FString("");
 
 				int32 Offset = GLTFMatName.Find(TEXT("_SKIN"), ESearchCase::IgnoreCase, ESearchDir::FromEnd);
 				if (Offset != INDEX_NONE)
@@ -732,9 +795,9 @@ bool GLTFMeshBuilder::BuildStaticMeshFromGeometry(tinygltf::Mesh* Mesh, UStaticM
 	//
 
 	TArray<tinygltf::Material*> FoundMaterials;
-	for (auto Prim : Mesh->primitives)
+	for (auto &Prim : Mesh->primitives)
 	{
-		tinygltf::Material* CurrentMaterial = &Scene->materials[Prim.material];
+		tinygltf::Material* CurrentMaterial = GetMaterial(Prim.material);
 		FoundMaterials.AddUnique(CurrentMaterial);
 	}
 
@@ -762,9 +825,14 @@ bool GLTFMeshBuilder::BuildStaticMeshFromGeometry(tinygltf::Mesh* Mesh, UStaticM
 		}
 		else
 		{
-			FString MaterialFullName = ObjectTools::SanitizeObjectName(ToFString(GLTFMaterial->name));
-			FString BasePackageName = PackageTools::SanitizePackageName(FPackageName::GetLongPackagePath(StaticMesh->GetOutermost()->GetName()) / MaterialFullName);
-			UMaterialInterface* UnrealMaterialInterface = FindObject<UMaterialInterface>(NULL, *(BasePackageName + TEXT(".") + MaterialFullName));
+			// glTF 2.0 primitives may leave out their material
+			UMaterialInterface* UnrealMaterialInterface = NULL;
+			if (GLTFMaterial)
+			{
+				FString MaterialFullName = ObjectTools::SanitizeObjectName(ToFString(GLTFMaterial->name));
+				FString BasePackageName = PackageTools::SanitizePackageName(FPackageName::GetLongPackagePath(StaticMesh->GetOutermost()->GetName()) / MaterialFullName);
+				UnrealMaterialInterface = FindObject<UMaterialInterface>(NULL, *(BasePackageName + TEXT(".") + MaterialFullName));
+			}
 			if (UnrealMaterialInterface == NULL)
 			{
 				UnrealMaterialInterface = UMaterial::GetDefaultMaterial(MD_Surface);
@@ -845,7 +913,7 @@ bool GLTFMeshBuilder::BuildStaticMeshFromGeometry(tinygltf::Mesh* Mesh, UStaticM
 
 	// Triangle indices
 	TArray<int32> NewWedgeIndices;
-	ConvertAttrib(NewWedgeIndices, Mesh, std::string("__WedgeIndices"));
+	GetWedgeIndices(NewWedgeIndices, (*Mesh));
 	int32 WedgeCount = NewWedgeIndices.Num();
 	int32 TriangleCount = WedgeCount / 3;
 	if (TriangleCount == 0)
@@ -965,28 +1033,9 @@ std::string GLTFMeshBuilder::ToStdString(FString InString)
 }
 
 template <typename T>
-bool GLTFMeshBuilder::GetBufferData(TArray<T> &OutArray, tinygltf::Accessor* Accessor, bool Append)
+bool GLTFMeshBuilder::GetBufferData(TArray<T> &OutArray, const tinygltf::AccessorView* View, bool Append)
 {
-	if (Accessor->type != TINYGLTF_TYPE_SCALAR)
-	{
-		return false;
-	}
-
-	if (!Accessor)
-	{
-		return false;
-	}
-
-	tinygltf::BufferView* BufferView = &Scene->bufferViews[Accessor->bufferView];
-
-	if (!BufferView)
-	{
-		return false;
-	}
-
-	tinygltf::Buffer* Buffer = &Scene->buffers[BufferView->buffer];
-
-	if (!Buffer)
+	if (!View || View->type != TINYGLTF_TYPE_SCALAR)
 	{
 		return false;
 	}
@@ -996,29 +1045,17 @@ bool GLTFMeshBuilder::GetBufferData(TArray<T> &OutArray, tinygltf::Accessor* Acc
 		OutArray.Empty();
 	}
 
-	size_t Stride;
-	if (Accessor->byteStride != 0)
+	switch (View->componentType)
 	{
-		Stride = Accessor->byteStride;
-	}
-	else
-	{
-		Stride = TypeSize(Accessor->componentType);
-	}
-
-	unsigned char* Start = &Buffer->data[Accessor->byteOffset + BufferView->byteOffset];
-
-	switch (Accessor->componentType)
-	{
-		case TINYGLTF_COMPONENT_TYPE_BYTE:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>			::Type, T>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE>	::Type, T>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_SHORT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>			::Type, T>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT>	::Type, T>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_INT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_INT>			::Type, T>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT>	::Type, T>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_FLOAT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>			::Type, T>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_DOUBLE:			BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>			::Type, T>(OutArray, Start, Accessor->count, Stride);	break;
-		default:										BufferCopy<T,														T>(OutArray, Start, Accessor->count, Stride);	break;
+		case TINYGLTF_COMPONENT_TYPE_BYTE:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>			::Type, T>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE>	::Type, T>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_SHORT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>			::Type, T>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT>	::Type, T>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_INT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_INT>			::Type, T>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT>	::Type, T>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_FLOAT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>			::Type, T>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_DOUBLE:			BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>			::Type, T>(OutArray, View->data, View->count, View->byteStride);	break;
+		default:										BufferCopy<T,														T>(OutArray, View->data, View->count, View->byteStride);	break;
 	}
 
 	return true;
@@ -1026,28 +1063,9 @@ bool GLTFMeshBuilder::GetBufferData(TArray<T> &OutArray, tinygltf::Accessor* Acc
 
 // This specialization is almost the same, but checks for the VEC2 GLTF type and uses the overloaded BufferCopy function for FVector2D
 template <>
-bool GLTFMeshBuilder::GetBufferData(TArray<FVector2D> &OutArray, tinygltf::Accessor* Accessor, bool Append)
+bool GLTFMeshBuilder::GetBufferData(TArray<FVector2D> &OutArray, const tinygltf::AccessorView* View, bool Append)
 {
-	if (Accessor->type != TINYGLTF_TYPE_VEC2)
-	{
-		return false;
-	}
-
-	if (!Accessor)
-	{
-		return false;
-	}
-
-	tinygltf::BufferView* BufferView = &Scene->bufferViews[Accessor->bufferView];
-
-	if (!BufferView)
-	{
-		return false;
-	}
-
-	tinygltf::Buffer* Buffer = &Scene->buffers[BufferView->buffer];
-
-	if (!Buffer)
+	if (!View || View->type != TINYGLTF_TYPE_VEC2)
 	{
 		return false;
 	}
@@ -1057,28 +1075,21 @@ bool GLTFMeshBuilder::GetBufferData(TArray<FVector2D> &OutArray, tinygltf::Acces
 		OutArray.Empty();
 	}
 
-	size_t Stride;
-	if (Accessor->byteStride != 0)
+	if (View->normalized)
 	{
-		Stride = Accessor->byteStride;
+		return BufferCopyNormalized(OutArray, View);
 	}
-	else
-	{
-		Stride = TypeSize(Accessor->componentType);
-	}
-
-	unsigned char* Start = &Buffer->data[Accessor->byteOffset + BufferView->byteOffset];
 
-	switch (Accessor->componentType)
+	switch (View->componentType)
 	{
-		case TINYGLTF_COMPONENT_TYPE_BYTE:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE>	::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_SHORT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT>	::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_INT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_INT>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT>	::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_FLOAT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_DOUBLE:			BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
+		case TINYGLTF_COMPONENT_TYPE_BYTE:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE>	::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_SHORT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT>	::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_INT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_INT>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT>	::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_FLOAT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_DOUBLE:			BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
 		default:										return false;
 	}
 
@@ -1087,28 +1098,9 @@ bool GLTFMeshBuilder::GetBufferData(TArray<FVector2D> &OutArray, tinygltf::Acces
 
 // This specialization is almost the same, but checks for the VEC3 GLTF type and uses the overloaded BufferCopy function for FVector
 template <>
-bool GLTFMeshBuilder::GetBufferData(TArray<FVector> &OutArray, tinygltf::Accessor* Accessor, bool Append)
+bool GLTFMeshBuilder::GetBufferData(TArray<FVector> &OutArray, const tinygltf::AccessorView* View, bool Append)
 {
-	if (Accessor->type != TINYGLTF_TYPE_VEC3)
-	{
-		return false;
-	}
-
-	if (!Accessor)
-	{
-		return false;
-	}
-
-	tinygltf::BufferView* BufferView = &Scene->bufferViews[Accessor->bufferView];
-
-	if (!BufferView)
-	{
-		return false;
-	}
-
-	tinygltf::Buffer* Buffer = &Scene->buffers[BufferView->buffer];
-
-	if (!Buffer)
+	if (!View || View->type != TINYGLTF_TYPE_VEC3)
 	{
 		return false;
 	}
@@ -1118,28 +1110,21 @@ bool GLTFMeshBuilder::GetBufferData(TArray<FVector> &OutArray, tinygltf::Accesso
 		OutArray.Empty();
 	}
 
-	size_t Stride;
-	if (Accessor->byteStride != 0)
-	{
-		Stride = Accessor->byteStride;
-	}
-	else
+	if (View->normalized)
 	{
-		Stride = TypeSize(Accessor->componentType);
+		return BufferCopyNormalized(OutArray, View);
 	}
 
-	unsigned char* Start = &Buffer->data[Accessor->byteOffset + BufferView->byteOffset];
-
-	switch (Accessor->componentType)
+	switch (View->componentType)
 	{
-		case TINYGLTF_COMPONENT_TYPE_BYTE:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE>	::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_SHORT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT>	::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_INT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_INT>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT>	::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_FLOAT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_DOUBLE:			BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
+		case TINYGLTF_COMPONENT_TYPE_BYTE:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE>	::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_SHORT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT>	::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_INT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_INT>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT>	::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_FLOAT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_DOUBLE:			BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
 		default:										return false;
 	}
 
@@ -1148,28 +1133,9 @@ bool GLTFMeshBuilder::GetBufferData(TArray<FVector> &OutArray, tinygltf::Accesso
 
 // This specialization is almost the same, but checks for the VEC4 GLTF type and uses the overloaded BufferCopy function for FVector4
 template <>
-bool GLTFMeshBuilder::GetBufferData(TArray<FVector4> &OutArray, tinygltf::Accessor* Accessor, bool Append)
+bool GLTFMeshBuilder::GetBufferData(TArray<FVector4> &OutArray, const tinygltf::AccessorView* View, bool Append)
 {
-	if (Accessor->type != TINYGLTF_TYPE_VEC4)
-	{
-		return false;
-	}
-
-	if (!Accessor)
-	{
-		return false;
-	}
-
-	tinygltf::BufferView* BufferView = &Scene->bufferViews[Accessor->bufferView];
-
-	if (!BufferView)
-	{
-		return false;
-	}
-
-	tinygltf::Buffer* Buffer = &Scene->buffers[BufferView->buffer];
-
-	if (!Buffer)
+	if (!View || View->type != TINYGLTF_TYPE_VEC4)
 	{
 		return false;
 	}
@@ -1179,28 +1145,21 @@ bool GLTFMeshBuilder::GetBufferData(TArray<FVector4> &OutArray, tinygltf::Access
 		OutArray.Empty();
 	}
 
-	size_t Stride;
-	if (Accessor->byteStride != 0)
-	{
-		Stride = Accessor->byteStride;
-	}
-	else
+	if (View->normalized)
 	{
-		Stride = TypeSize(Accessor->componentType);
+		return BufferCopyNormalized(OutArray, View);
 	}
 
-	unsigned char* Start = &Buffer->data[Accessor->byteOffset + BufferView->byteOffset];
-
-	switch (Accessor->componentType)
+	switch (View->componentType)
 	{
-		case TINYGLTF_COMPONENT_TYPE_BYTE:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE>	::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_SHORT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT>	::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_INT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_INT>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT>	::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_FLOAT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_DOUBLE:			BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>			::Type>(OutArray, Start, Accessor->count, Stride);	break;
+		case TINYGLTF_COMPONENT_TYPE_BYTE:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE>	::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_SHORT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT>	::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_INT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_INT>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT>	::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_FLOAT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_DOUBLE:			BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>			::Type>(OutArray, View->data, View->count, View->byteStride);	break;
 		default:										return false;
 	}
 
@@ -1209,28 +1168,9 @@ bool GLTFMeshBuilder::GetBufferData(TArray<FVector4> &OutArray, tinygltf::Access
 
 // This specialization is almost the same, but checks for a VEC3 or VEC4 GLTF type and uses the overloaded BufferCopy function for FColor
 template <>
-bool GLTFMeshBuilder::GetBufferData(TArray<FColor> &OutArray, tinygltf::Accessor* Accessor, bool Append)
+bool GLTFMeshBuilder::GetBufferData(TArray<FColor> &OutArray, const tinygltf::AccessorView* View, bool Append)
 {
-	if (Accessor->type != TINYGLTF_TYPE_VEC3 && Accessor->type != TINYGLTF_TYPE_VEC4)
-	{
-		return false;
-	}
-
-	if (!Accessor)
-	{
-		return false;
-	}
-
-	tinygltf::BufferView* BufferView = &Scene->bufferViews[Accessor->bufferView];
-
-	if (!BufferView)
-	{
-		return false;
-	}
-
-	tinygltf::Buffer* Buffer = &Scene->buffers[BufferView->buffer];
-
-	if (!Buffer)
+	if (!View || (View->type != TINYGLTF_TYPE_VEC3 && View->type != TINYGLTF_TYPE_VEC4))
 	{
 		return false;
 	}
@@ -1240,28 +1180,35 @@ bool GLTFMeshBuilder::GetBufferData(TArray<FColor> &OutArray, tinygltf::Accessor
 		OutArray.Empty();
 	}
 
-	size_t Stride;
-	if (Accessor->byteStride != 0)
-	{
-		Stride = Accessor->byteStride;
-	}
-	else
+	if (View->normalized)
 	{
-		Stride = TypeSize(Accessor->componentType);
-	}
+		// Decode to [0, 1] first so that 16-bit colors keep their most significant bits
+		const int32 Components = View->type == TINYGLTF_TYPE_VEC4 ? 4 : 3;
+		TArray<float> Values;
+		Values.AddUninitialized(View->count * Components);
+		if (!tinygltf::DecodeNormalized(Values.GetData(), View->data, View->count, View->byteStride, Components, View->componentType))
+		{
+			return false;
+		}
 
-	unsigned char* Start = &Buffer->data[Accessor->byteOffset + BufferView->byteOffset];
+		OutArray.Reserve(OutArray.Num() + View->count);
+		for (int32 i = 0; i < Values.Num(); i += Components)
+		{
+			OutArray.Add(FLinearColor(Values[i], Values[i + 1], Values[i + 2], Components == 4 ? Values[i + 3] : 1.0f).ToFColor(false));
+		}
+		return true;
+	}
 
-	switch (Accessor->componentType)
+	switch (View->componentType)
 	{
-		case TINYGLTF_COMPONENT_TYPE_BYTE:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>			::Type>(OutArray, Accessor->type, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE>	::Type>(OutArray, Accessor->type, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_SHORT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>			::Type>(OutArray, Accessor->type, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT>	::Type>(OutArray, Accessor->type, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_INT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_INT>			::Type>(OutArray, Accessor->type, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT>	::Type>(OutArray, Accessor->type, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_FLOAT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>			::Type>(OutArray, Accessor->type, Start, Accessor->count, Stride);	break;
-		case TINYGLTF_COMPONENT_TYPE_DOUBLE:			BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>			::Type>(OutArray, Accessor->type, Start, Accessor->count, Stride);	break;
+		case TINYGLTF_COMPONENT_TYPE_BYTE:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>			::Type>(OutArray, View->type, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE>	::Type>(OutArray, View->type, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_SHORT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>			::Type>(OutArray, View->type, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT>	::Type>(OutArray, View->type, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_INT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_INT>			::Type>(OutArray, View->type, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT>	::Type>(OutArray, View->type, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_FLOAT:				BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>			::Type>(OutArray, View->type, View->data, View->count, View->byteStride);	break;
+		case TINYGLTF_COMPONENT_TYPE_DOUBLE:			BufferCopy<GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>			::Type>(OutArray, View->type, View->data, View->count, View->byteStride);	break;
 		default:										return false;
 	}
 
@@ -1270,30 +1217,35 @@ bool GLTFMeshBuilder::GetBufferData(TArray<FColor> &OutArray, tinygltf::Accessor
 
 bool GLTFMeshBuilder::HasAttribute(tinygltf::Mesh* Mesh, std::string AttribName) const
 {
-	for (auto Prim : Mesh->primitives)
+	for (auto &Prim : Mesh->primitives)
 	{
-		for (auto Entry : Prim.attributes)
+		if (Prim.attributes.find(AttribName) != Prim.attributes.end())
 		{
-			if (Entry.first == AttribName)
-			{
-				return true;
-			}
+			return true;
 		}
 	}
 	return false;
 }
 
-template <typename T> int32 GLTFMeshBuilder::FindInStdVector(const std::vector<T> &InVector, const T &InElement) const
+const tinygltf::AccessorView* GLTFMeshBuilder::GetAccessorView(int32 Handle) const
+{
+	return Handle >= 0 ? &Scene->accessorViews[Handle] : NULL;
+}
+
+tinygltf::Material* GLTFMeshBuilder::GetMaterial(int32 Handle) const
 {
-	for (int32 i = 0; i < InVector.size(); ++i)
+	return Handle >= 0 ? &Scene->materials[Handle] : NULL;
+}
+
+int32 GLTFMeshBuilder::GetCornerAccessor(tinygltf::Primitive* Prim) const
+{
+	if (Prim->indices >= 0)
 	{
-		if (InVector[i] == InElement)
-		{
-			return i;
-		}
+		return Prim->indices;
 	}
 
-	return -1;
+	auto Position = Prim->attributes.find("POSITION");
+	return Position != Prim->attributes.end() ? Position->second : -1;
 }
 
 FMatrix GLTFMeshBuilder::GetNodeTransform(tinygltf::Node* Node)
@@ -1324,63 +1276,174 @@ FMatrix GLTFMeshBuilder::GetNodeTransform(tinygltf::Node* Node)
 	}
 }
 
-size_t GLTFMeshBuilder::TypeSize(int Type) const
+int32 GLTFMeshBuilder::GetNumWedges(tinygltf::Primitive* Prim) const
 {
-	switch (Type)
+	const tinygltf::AccessorView* CornerAccessor = GetAccessorView(GetCornerAccessor(Prim));
+	if (!CornerAccessor)
 	{
-		case TINYGLTF_COMPONENT_TYPE_BYTE:
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-			return sizeof(GLTFType<TINYGLTF_COMPONENT_TYPE_BYTE>::Type);
+		return 0;
+	}
 
-		case TINYGLTF_COMPONENT_TYPE_SHORT:
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-			return sizeof(GLTFType<TINYGLTF_COMPONENT_TYPE_SHORT>::Type);
+	switch (Prim->mode)
+	{
+		case TINYGLTF_MODE_TRIANGLES:
+			return CornerAccessor->count;
 
-		case TINYGLTF_COMPONENT_TYPE_INT:
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-			return sizeof(GLTFType<TINYGLTF_COMPONENT_TYPE_INT>::Type);
+		case TINYGLTF_MODE_TRIANGLE_STRIP:
+		case TINYGLTF_MODE_TRIANGLE_FAN:
+			// Matches the expansion in GetCachedWedgeIndices, so fewer than three indices give no triangles
+			return FMath::Max((int32)CornerAccessor->count - 2, 0) * 3;
 
-		case TINYGLTF_COMPONENT_TYPE_FLOAT:
-			return sizeof(GLTFType<TINYGLTF_COMPONENT_TYPE_FLOAT>::Type);
+		default:
+			return 0;
+	}
+}
 
-		case TINYGLTF_COMPONENT_TYPE_DOUBLE:
-			return sizeof(GLTFType<TINYGLTF_COMPONENT_TYPE_DOUBLE>::Type);
+void GLTFMeshBuilder::GetMaterialIndices(TArray<int32>& OutArray, tinygltf::Mesh& Mesh)
+{
+	for (auto &Prim : Mesh.primitives)
+	{
+		int32 Index = MeshMaterials.Find(Prim.material);
+		const TArray<int32>* WedgeIndices = GetCachedWedgeIndices(&Prim);
+		int32 NumTriangles = WedgeIndices ? WedgeIndices->Num() / 3 : 0;
+		for (int i = 0; i < NumTriangles; ++i)
+		{
+			OutArray.Add(Index);
+		}
+	}
+}
 
-		default:
-			return -1;
+void GLTFMeshBuilder::GetWedgeIndices(TArray<int32>& OutArray, tinygltf::Mesh& Mesh)
+{
+	for (auto &Prim : Mesh.primitives)
+	{
+		const TArray<int32>* WedgeIndices = GetCachedWedgeIndices(&Prim);
+		if (WedgeIndices)
+		{
+			OutArray.Append(*WedgeIndices);
+		}
 	}
 }
 
-int32 GLTFMeshBuilder::GetNumWedges(tinygltf::Primitive* Prim) const
+const TArray<int32>* GLTFMeshBuilder::GetCachedWedgeIndices(tinygltf::Primitive* Prim)
 {
+	const int32 CornerAccessor = GetCornerAccessor(Prim);
+	if (CornerAccessor < 0)
+	{
+		return NULL;
+	}
+
+	// The same accessor drawn with another mode expands differently, and its vertices drawn in order differ from its values used as indices
+	const bool bIndexed = Prim->indices >= 0;
+	const uint64 Key = (bIndexed ? 0 : (uint64)1 << 63) | ((uint64)(uint32)Prim->mode << 32) | (uint32)CornerAccessor;
+	if (const TArray<int32>* Cached = WedgeIndexCache.Find(Key))
+	{
+		return Cached;
+	}
+
+	TArray<int32> IndexArray;
+	if (bIndexed)
+	{
+		if (!GetBufferData(IndexArray, GetAccessorView(CornerAccessor)))
+		{
+			return NULL;
+		}
+	}
+	else
+	{
+		const int32 NumVertices = (int32)GetAccessorView(CornerAccessor)->count;
+		IndexArray.SetNumUninitialized(NumVertices);
+		for (int32 i = 0; i < NumVertices; ++i)
+		{
+			IndexArray[i] = i;
+		}
+	}
+
+	TArray<int32> WedgeIndices;
 	switch (Prim->mode)
 	{
 		case TINYGLTF_MODE_TRIANGLES:
-			return Prim->indices.size();
+			WedgeIndices = MoveTemp(IndexArray);
+			break;
 
 		case TINYGLTF_MODE_TRIANGLE_STRIP:
+			WedgeIndices.Reserve(FMath::Max(IndexArray.Num() - 2, 0) * 3);
+			for (int32 i = 0; i + 2 < IndexArray.Num(); ++i)
+			{
+				// Every other triangle is flipped to keep the winding consistent
+				WedgeIndices.Add(IndexArray[i % 2 == 0 ? i : i + 1]);
+				WedgeIndices.Add(IndexArray[i % 2 == 0 ? i + 1 : i]);
+				WedgeIndices.Add(IndexArray[i + 2]);
+			}
+			break;
+
 		case TINYGLTF_MODE_TRIANGLE_FAN:
-			return (Prim->indices.size() - 2) * 3;
+			WedgeIndices.Reserve(FMath::Max(IndexArray.Num() - 2, 0) * 3);
+			for (int32 i = 1; i + 1 < IndexArray.Num(); ++i)
+			{
+				WedgeIndices.Add(IndexArray[0]);
+				WedgeIndices.Add(IndexArray[i]);
+				WedgeIndices.Add(IndexArray[i + 1]);
+			}
+			break;
 
 		default:
-			return 0;
+			return NULL;
 	}
+
+	return &WedgeIndexCache.Add(Key, MoveTemp(WedgeIndices));
 }
 
-void GLTFMeshBuilder::GetMaterialIndices(TArray<int32>& OutArray, tinygltf::Mesh& Mesh)
+template <typename SrcType, typename DstType> bool GLTFMeshBuilder::BufferCopyBulk(TArray<DstType>& OutArray, const unsigned char* Data, int32 Count, size_t Stride)
 {
-	for (auto Prim : Mesh.primitives)
+	// glTF data is little endian, so only then do the bytes already match
+	if (!GLTFPackedCopy<SrcType, DstType>::Value || !PLATFORM_LITTLE_ENDIAN)
+	{
+		return false;
+	}
+
+	// Interleaved floats, e.g. positions, normals and UVs sharing one bufferView, are gathered out of the other attributes
+	const bool bPacked = Stride == sizeof(DstType);
+	const bool bInterleaved = TAreTypesEqual<SrcType, float>::Value && Stride > sizeof(DstType);
+	if (!bPacked && !bInterleaved)
+	{
+		return false;
+	}
+
+	if (Count > 0)
 	{
-		int32 Index = MeshMaterials.Find(ToFString(Prim.material));
-		for (int i = 0; i < GetNumWedges(&Prim) / 3; ++i)
+		int32 Start = OutArray.AddUninitialized(Count);
+		if (bPacked)
 		{
-			OutArray.Add(Index);
+			FMemory::Memcpy(OutArray.GetData() + Start, Data, Count * sizeof(DstType));
+		}
+		else
+		{
+			tinygltf::GatherFloats(reinterpret_cast<float*>(OutArray.GetData() + Start), Data, Count, Stride, sizeof(DstType) / sizeof(float));
 		}
 	}
+	return true;
 }
 
-template <typename SrcType, typename DstType> void GLTFMeshBuilder::BufferCopy(TArray<DstType>& OutArray, unsigned char* Data, int32 Count, size_t Stride)
+template <typename DstType> bool GLTFMeshBuilder::BufferCopyNormalized(TArray<DstType>& OutArray, const tinygltf::AccessorView* View)
 {
+	int32 Start = OutArray.AddUninitialized(View->count);
+	if (!tinygltf::DecodeNormalized(reinterpret_cast<float*>(OutArray.GetData() + Start), View->data, View->count, View->byteStride, sizeof(DstType) / sizeof(float), View->componentType))
+	{
+		OutArray.SetNum(Start);
+		return false;
+	}
+	return true;
+}
+
+template <typename SrcType, typename DstType> void GLTFMeshBuilder::BufferCopy(TArray<DstType>& OutArray, const unsigned char* Data, int32 Count, size_t Stride)
+{
+	if (BufferCopyBulk<SrcType>(OutArray, Data, Count, Stride))
+	{
+		return;
+	}
+
+	OutArray.Reserve(OutArray.Num() + Count);
 	for (int32 i = 0; i < Count; ++i)
 	{
 		// At this point, assume we can cast directly to the destination type
@@ -1389,8 +1452,14 @@ template <typename SrcType, typename DstType> void GLTFMeshBuilder::BufferCopy(T
 	}
 }
 
-template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FVector2D> &OutArray, unsigned char* Data, int32 Count, size_t Stride)
+template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FVector2D> &OutArray, const unsigned char* Data, int32 Count, size_t Stride)
 {
+	if (BufferCopyBulk<SrcType>(OutArray, Data, Count, Stride))
+	{
+		return;
+	}
+
+	OutArray.Reserve(OutArray.Num() + Count);
 	for (int32 i = 0; i < Count; ++i)
 	{
 		// At this point, assume we can cast directly to the destination type
@@ -1399,8 +1468,14 @@ template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FVector2D> &
 	}
 }
 
-template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FVector> &OutArray, unsigned char* Data, int32 Count, size_t Stride)
+template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FVector> &OutArray, const unsigned char* Data, int32 Count, size_t Stride)
 {
+	if (BufferCopyBulk<SrcType>(OutArray, Data, Count, Stride))
+	{
+		return;
+	}
+
+	OutArray.Reserve(OutArray.Num() + Count);
 	for (int32 i = 0; i < Count; ++i)
 	{
 		// At this point, assume we can cast directly to the destination type
@@ -1409,8 +1484,14 @@ template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FVector> &Ou
 	}
 }
 
-template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FVector4> &OutArray, unsigned char* Data, int32 Count, size_t Stride)
+template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FVector4> &OutArray, const unsigned char* Data, int32 Count, size_t Stride)
 {
+	if (BufferCopyBulk<SrcType>(OutArray, Data, Count, Stride))
+	{
+		return;
+	}
+
+	OutArray.Reserve(OutArray.Num() + Count);
 	for (int32 i = 0; i < Count; ++i)
 	{
 		// At this point, assume we can cast directly to the destination type
@@ -1419,8 +1500,9 @@ template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FVector4> &O
 	}
 }
 
-template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FColor> &OutArray, int InType, unsigned char* Data, int32 Count, size_t Stride)
+template <typename SrcType> void GLTFMeshBuilder::BufferCopy(TArray<FColor> &OutArray, int InType, const unsigned char* Data, int32 Count, size_t Stride)
 {
+	OutArray.Reserve(OutArray.Num() + Count);
 	switch (InType)
 	{
 		case TINYGLTF_TYPE_VEC3:
@@ -18,6 +18,7 @@ struct FRawMesh;
 namespace tinygltf
 {
 	class TinyGLTFLoader;
+	class ResourceCache;
 	class Scene;
 	class Node;
 	struct ACCESSOR;
@@ -34,7 +35,39 @@ namespace tinygltf
 class GLTFMeshBuilder
 {
 public:
+	/// While an instance is alive, every builder shares one cache of external resources (.bin files, textures),
+	/// so files referenced by several glTF files of an import batch are read from disk only once.
+	/// Scopes may be nested; the cache is released when the outermost one ends.
+	struct FScopedImportBatch
+	{
+		FScopedImportBatch();
+		~FScopedImportBatch();
+	};
+
+	/// Counts and estimated sizes of a glTF file's contents, obtained without importing it.
+	struct FSceneSummary
+	{
+		int32 Meshes;
+		int32 Primitives;
+		int32 Nodes;
+		int32 Materials;
+		int32 Textures;
+		int32 Images;
+		int64 Triangles;
+		/// Size of the data referenced by accessors, i.e. the vertex and index data.
+		int64 AccessorBytes;
+		/// Declared size of all buffers.
+		int64 BufferBytes;
+	};
+
+	/// Reads only the JSON structure of a glTF file to fill OutSummary; buffers and images are never opened,
+	/// so this is fast even for large files. Returns false and sets OutError if the file could not be read.
+	static bool ScanFile(const FString& FilePath, FSceneSummary& OutSummary, FString& OutError);
+
 	GLTFMeshBuilder(FString FilePath);
+	/// Loads the scene from file contents that are already in memory, such as the buffer handed to the factory.
+	/// Geometry may be read from this memory in place, so it must outlive the builder.
+	GLTFMeshBuilder(FString FilePath, const uint8* Buffer, const uint8* BufferEnd);
 	~GLTFMeshBuilder();
 
 	/// Returns whether we have a valid glTF scene loaded up. For a new MeshBuilder, this should always be queried before calling other functions.
@@ -94,14 +127,14 @@ private:
 
 	/// @name Level 3: GetBufferData
 	///@{
-	/// Fills a TArray with typed data; works at the glTF Accessor level and figures out which arguments to send to <B>BufferCopy()</B>.
+	/// Fills a TArray with typed data; works at the glTF Accessor level and figures out which arguments to send to <B>BufferCopy()</B>, or to <B>BufferCopyNormalized()</B> for normalized integer accessors.
 	/// @param OutArray The array to fill with data from the imported file.
-	/// @param Accessor A pointer to a glTF Accessor containing the type data for the geometry attribute.
+	/// @param View The resolved view of a glTF Accessor, locating the data for the geometry attribute in its buffer.
 	/// @param Append Whether to add to the array or overwrite the elements currently in it.
-	template <typename T>	bool GetBufferData				(TArray<T>			&OutArray, tinygltf::Accessor* Accessor, bool Append = true);
-	template <>				bool GetBufferData<FVector2D>	(TArray<FVector2D>	&OutArray, tinygltf::Accessor* Accessor, bool Append	   );
-	template <>				bool GetBufferData<FVector>		(TArray<FVector>	&OutArray, tinygltf::Accessor* Accessor, bool Append	   );
-	template <>				bool GetBufferData<FVector4>	(TArray<FVector4>	&OutArray, tinygltf::Accessor* Accessor, bool Append	   );
+	template <typename T>	bool GetBufferData				(TArray<T>			&OutArray, const tinygltf::AccessorView* View, bool Append = true);
+	template <>				bool GetBufferData<FVector2D>	(TArray<FVector2D>	&OutArray, const tinygltf::AccessorView* View, bool Append	   );
+	template <>				bool GetBufferData<FVector>		(TArray<FVector>	&OutArray, const tinygltf::AccessorView* View, bool Append	   );
+	template <>				bool GetBufferData<FVector4>	(TArray<FVector4>	&OutArray, const tinygltf::AccessorView* View, bool Append	   );
 	///@}
 
 	/// @name Level 2: BufferCopy
@@ -111,11 +144,17 @@ private:
 	/// @param Data A pointer to the raw data to use as the argument to <B>BufferValue()</B>.
 	/// @param Count The number of elements to add to the array i.e. the number of calls to <B>BufferValue()</B>.
 	/// @param Stride The number of bytes between the first byte of each element - usually the size of one element.
-	template <typename SrcType, typename DstType>	void BufferCopy(TArray<DstType>		&OutArray, unsigned char* Data, int32 Count, size_t Stride);
-	template <typename SrcType>						void BufferCopy(TArray<FVector2D>	&OutArray, unsigned char* Data, int32 Count, size_t Stride);
-	template <typename SrcType>						void BufferCopy(TArray<FVector>		&OutArray, unsigned char* Data, int32 Count, size_t Stride);
-	template <typename SrcType>						void BufferCopy(TArray<FVector4>	&OutArray, unsigned char* Data, int32 Count, size_t Stride);
-	template <typename SrcType>						void BufferCopy(TArray<FColor>		&OutArray, int Type, unsigned char* Data, int32 Count, size_t Stride);
+	template <typename SrcType, typename DstType>	void BufferCopy(TArray<DstType>		&OutArray, const unsigned char* Data, int32 Count, size_t Stride);
+	template <typename SrcType>						void BufferCopy(TArray<FVector2D>	&OutArray, const unsigned char* Data, int32 Count, size_t Stride);
+	template <typename SrcType>						void BufferCopy(TArray<FVector>		&OutArray, const unsigned char* Data, int32 Count, size_t Stride);
+	template <typename SrcType>						void BufferCopy(TArray<FVector4>	&OutArray, const unsigned char* Data, int32 Count, size_t Stride);
+	template <typename SrcType>						void BufferCopy(TArray<FColor>		&OutArray, int Type, const unsigned char* Data, int32 Count, size_t Stride);
+	/// Copies the data in bulk if each element already has the bytes of a DstType, as with float VEC3 into FVector: with a single memcpy if it is packed (Stride is the size of DstType), or with the SIMD gather kernels if it is interleaved float data.
+	/// @return Whether the data was copied; if not, the caller converts it element by element.
+	template <typename SrcType, typename DstType>	bool BufferCopyBulk(TArray<DstType>		&OutArray, const unsigned char* Data, int32 Count, size_t Stride);
+	/// Decodes normalized 8 or 16-bit integers to [0, 1] or [-1, 1] for a float vector type (e.g. quantized texcoords and normals).
+	/// @return False if the accessor's components are not 8 or 16-bit integers.
+	template <typename DstType>						bool BufferCopyNormalized(TArray<DstType>	&OutArray, const tinygltf::AccessorView* View);
 	///@}
 
 	/// @name Level 1: BufferValue
@@ -124,24 +163,37 @@ private:
 	/// Adapted from http://stackoverflow.com/questions/13001183/how-to-read-little-endian-integers-from-file-in-c
 	/// @param Data A pointer to the raw data to cast to the desired type.
 	/// @return The typed data value.
-	template <typename T> T BufferValue(void* Data);
+	template <typename T> T BufferValue(const void* Data);
 	///@}
 
 	/// Separate function to obtain material indices since it is not stored as a buffer. Should be called after MeshMaterials has been filled in.
 	void GetMaterialIndices(TArray<int32>& OutArray, tinygltf::Mesh& Mesh);
+	/// Obtains the vertex index of every triangle corner ("wedge") of a mesh, i.e. its index buffers expanded to triangle lists.
+	void GetWedgeIndices(TArray<int32>& OutArray, tinygltf::Mesh& Mesh);
+	/// Returns a primitive's wedge indices, decoding and expanding its index buffer on first use, or NULL if it has no vertices or uses an unsupported draw mode.
+	/// Primitives without an index buffer (allowed in glTF 2.0) draw their vertices in order.
+	/// The pointer is only valid until the next call, which may grow the cache.
+	const TArray<int32>* GetCachedWedgeIndices(tinygltf::Primitive* Prim);
 	
 	// Miscellaneous helper functions
 
+	/// Creates the TinyGLTF loader and scene, and routes the loader's parallel work through the engine's task graph.
+	void CreateLoader();
+
 	/// Reverses the order of every group of 3 elements.
 	template<typename T> void ReverseTriDirection(TArray<T>& OutArray);
 	/// Whether a mesh's geometry has a specified attribute.
 	bool HasAttribute(tinygltf::Mesh* Mesh, std::string AttribName) const;
-	/// Similar to TArray's Find() function; returns the array index if the specified object was found, -1 otherwise.
-	template <typename T> int32 FindInStdVector(const std::vector<T> &InVector, const T &InElement) const;
+	/// @name Handle Lookup
+	///@{
+	/// Return the scene entry for a handle, or NULL for -1 (not set in the file).
+	const tinygltf::AccessorView* GetAccessorView(int32 Handle) const;
+	tinygltf::Material* GetMaterial(int32 Handle) const;
+	/// Return the accessor a primitive's triangle corners come from: its indices, or its positions if it has none.
+	int32 GetCornerAccessor(tinygltf::Primitive* Prim) const;
+	///@}
 	/// Returns the transform of a node relative to its parent.
 	FMatrix GetNodeTransform(tinygltf::Node* Node);
-	/// Returns the size of the C++ data type given the corresponding glTF type.
-	size_t TypeSize(int Type) const;
 	/// Returns the number of triangle corners given a glTF primitive, taking into account its draw mode.
 	int32 GetNumWedges(tinygltf::Primitive* Prim) const;
 	/// Returns the owning node of a given mesh.
@@ -158,7 +210,8 @@ private:
 	TWeakObjectPtr<UObject> Parent;
 	tinygltf::TinyGLTFLoader* Loader;
 	tinygltf::Scene* Scene;
-	TArray<FString> MeshMaterials;
+	TArray<int32> MeshMaterials; // Material handles
+	TMap<uint64, TArray<int32>> WedgeIndexCache; // Wedge indices by draw mode and corner accessor handle, shared by all attributes and meshes of this import
 	bool LoadSuccess;
 	FString Error;
 };
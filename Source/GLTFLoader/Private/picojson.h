@@ -29,6 +29,7 @@
 #define picojson_h
 
 #include <algorithm>
+#include <cfloat>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -82,6 +83,21 @@ extern "C" {
 }
 #endif
 
+// to scan whitespace and strings one byte at a time, set PICOJSON_USE_SSE2 to 0
+#ifndef PICOJSON_USE_SSE2
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define PICOJSON_USE_SSE2 1
+# else
+#  define PICOJSON_USE_SSE2 0
+# endif
+#endif
+#if PICOJSON_USE_SSE2
+# include <emmintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+# endif
+#endif
+
 #ifndef PICOJSON_ASSERT
 # define PICOJSON_ASSERT(e) do { if (! (e)) throw std::runtime_error(#e); } while (0)
 #endif
@@ -548,6 +564,92 @@ namespace picojson {
     return s;
   }
   
+  inline bool _is_ws(int ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+  }
+  
+  inline bool _is_string_special(int ch) {
+    return ch == '"' || ch == '\\' || ch < ' ';
+  }
+  
+  // Block scanners over [p, end). _skip_ws_chars returns the first
+  // non-whitespace position (or end) and adds the newlines passed to
+  // `newlines`; _find_string_special returns the first '"', '\\' or control
+  // character (or end). Contiguous input is scanned 16 bytes at a time.
+  template <typename Iter> inline Iter _skip_ws_chars(Iter p, const Iter& end, int& newlines) {
+    for (; p != end; ++p) {
+      int ch = *p & 0xff;
+      if (! _is_ws(ch)) {
+	break;
+      }
+      newlines += ch == '\n';
+    }
+    return p;
+  }
+  
+  template <typename Iter> inline Iter _find_string_special(Iter p, const Iter& end) {
+    for (; p != end && ! _is_string_special(*p & 0xff); ++p)
+      ;
+    return p;
+  }
+  
+#if PICOJSON_USE_SSE2
+  inline int _first_bit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+  }
+  
+  inline int _count_bits(unsigned mask) {
+    // newline runs are short, so this beats a table or popcnt, which SSE2 targets lack
+    int n = 0;
+    for (; mask != 0; mask &= mask - 1) {
+      n++;
+    }
+    return n;
+  }
+  
+  inline const char* _skip_ws_chars(const char* p, const char* end, int& newlines) {
+    // minified documents mostly have no whitespace at all
+    if (p == end || ! _is_ws(*p & 0xff)) {
+      return p;
+    }
+    const __m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'), lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+    for (; end - p >= 16; p += 16) {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      __m128i nl = _mm_cmpeq_epi8(x, lf);
+      __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, space), _mm_cmpeq_epi8(x, tab)), _mm_or_si128(nl, _mm_cmpeq_epi8(x, cr)));
+      unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xffff;
+      unsigned lines = static_cast<unsigned>(_mm_movemask_epi8(nl));
+      if (stop != 0) {
+	int n = _first_bit(stop);
+	newlines += _count_bits(lines & ((1u << n) - 1));
+	return p + n;
+      }
+      newlines += _count_bits(lines);
+    }
+    return _skip_ws_chars<const char*>(p, end, newlines);
+  }
+  
+  inline const char* _find_string_special(const char* p, const char* end) {
+    const __m128i quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\'), control = _mm_set1_epi8(0x1f);
+    for (; end - p >= 16; p += 16) {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      // bytes below 0x20 are the ones for which max(x, 0x1f) == 0x1f
+      __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, backslash)), _mm_cmpeq_epi8(_mm_max_epu8(x, control), control));
+      unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+      if (mask != 0) {
+	return p + _first_bit(mask);
+      }
+    }
+    return _find_string_special<const char*>(p, end);
+  }
+#endif
+  
   template <typename Iter> class input {
   protected:
     Iter cur_, end_;
@@ -555,7 +657,7 @@ namespace picojson {
     bool ungot_;
     int line_;
   public:
-    input(const Iter& first, const Iter& last) : cur_(first), end_(last), last_ch_(-1), ungot_(false), line_(1) {}
+    input(const Iter& first, const Iter& last, int line = 1) : cur_(first), end_(last), last_ch_(-1), ungot_(false), line_(line) {}
     int getc() {
       if (ungot_) {
 	ungot_ = false;
@@ -580,14 +682,27 @@ namespace picojson {
     }
     Iter cur() const { return cur_; }
     int line() const { return line_; }
+    // Continues reading at `pos`, which is on line `line`, for callers that
+    // scanned ahead of the parser by themselves.
+    void seek(const Iter& pos, int line) {
+      cur_ = pos;
+      last_ch_ = -1;
+      ungot_ = false;
+      line_ = line;
+    }
+    // Consumes the rest of a string whose opening quote has been read if it
+    // has no escape sequences, and sets [first, last) to its characters in
+    // the source. Otherwise consumes nothing and returns false.
+    bool plain_string(Iter& first, Iter& last) {
+      return _plain_string(first, last, typename std::iterator_traits<Iter>::iterator_category());
+    }
     void skip_ws() {
-      while (1) {
-	int ch = getc();
-	if (! (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r')) {
-	  ungetc();
-	  break;
-	}
-      }
+      _skip_ws(typename std::iterator_traits<Iter>::iterator_category());
+    }
+    // Appends the characters up to the next '"', '\\' or control character of
+    // the string being read to `out` and consumes them.
+    template <typename String> void append_plain(String& out) {
+      _append_plain(out, typename std::iterator_traits<Iter>::iterator_category());
     }
     bool expect(int expect) {
       skip_ws();
@@ -608,6 +723,69 @@ namespace picojson {
       }
       return true;
     }
+  private:
+    void _skip_ws(std::input_iterator_tag) {
+      while (1) {
+	int ch = getc();
+	if (! _is_ws(ch)) {
+	  ungetc();
+	  break;
+	}
+      }
+    }
+    void _skip_ws(std::forward_iterator_tag) {
+      if (ungot_) {
+	if (! _is_ws(last_ch_)) {
+	  return;
+	}
+	ungot_ = false;
+      }
+      int newlines = 0;
+      Iter p = _skip_ws_chars(cur_, end_, newlines);
+      if (p == end_) {
+	// let getc() settle the state at the end of input
+	_skip_ws(std::input_iterator_tag());
+	return;
+      }
+      // same state as reading up to *p with getc() and ungetting it
+      line_ += (last_ch_ == '\n') + newlines;
+      last_ch_ = *p & 0xff;
+      cur_ = ++p;
+      ungot_ = true;
+    }
+    template <typename String> void _append_plain(String&, std::input_iterator_tag) {
+    }
+    template <typename String> void _append_plain(String& out, std::forward_iterator_tag) {
+      if (ungot_) {
+	return;
+      }
+      Iter p = _find_string_special(cur_, end_);
+      if (p != cur_) {
+	// the run holds no newlines, so line_ is unchanged
+	out.append(cur_, p);
+	Iter prev = p;
+	last_ch_ = *--prev & 0xff;
+	cur_ = p;
+      }
+    }
+    bool _plain_string(Iter&, Iter&, std::input_iterator_tag) {
+      // single-pass iterators cannot look ahead
+      return false;
+    }
+    bool _plain_string(Iter& first, Iter& last, std::forward_iterator_tag) {
+      if (ungot_) {
+	return false;
+      }
+      Iter p = _find_string_special(cur_, end_);
+      if (p == end_ || *p != '"') {
+	return false;
+      }
+      first = cur_;
+      last = p;
+      cur_ = ++p;
+      last_ch_ = '"';
+      return true;
+    }
   };
   
   template<typename Iter> inline int _parse_quadhex(input<Iter> &in) {
@@ -674,6 +852,7 @@ namespace picojson {
   
   template<typename String, typename Iter> inline bool _parse_string(String& out, input<Iter>& in) {
     while (1) {
+      in.append_plain(out);
       int ch = in.getc();
       if (ch < ' ') {
 	in.ungetc();
@@ -727,6 +906,38 @@ namespace picojson {
     return in.expect(']') && ctx.parse_array_stop(idx);
   }
   
+  // Key of an object member. Keys without escape sequences are referenced in
+  // the source and only copied into a std::string if a context asks for one.
+  template <typename Iter> class object_key {
+  public:
+    object_key() : plain_(false) {}
+    bool parse(input<Iter>& in) {
+      if (in.plain_string(first_, last_)) {
+	plain_ = true;
+	return true;
+      }
+      plain_ = false;
+      str_.clear();
+      return _parse_string(str_, in);
+    }
+    // true if the key is [begin(), end()) in the source; str() otherwise
+    bool is_plain() const { return plain_; }
+    Iter begin() const { return first_; }
+    Iter end() const { return last_; }
+    const std::string& str() const {
+      if (plain_) {
+	str_.assign(first_, last_);
+	plain_ = false;
+      }
+      return str_;
+    }
+    operator const std::string&() const { return str(); }
+  private:
+    Iter first_, last_;
+    mutable bool plain_;
+    mutable std::string str_;
+  };
+
   template <typename Context, typename Iter> inline bool _parse_object(Context& ctx, input<Iter>& in) {
     if (! ctx.parse_object_start()) {
       return false;
@@ -734,10 +945,10 @@ namespace picojson {
     if (in.expect('}')) {
       return true;
     }
+    object_key<Iter> key;
     do {
-      std::string key;
       if (! in.expect('"')
-	  || ! _parse_string(key, in)
+	  || ! key.parse(in)
 	  || ! in.expect(':')) {
 	return false;
       }
@@ -748,25 +959,166 @@ namespace picojson {
     return in.expect('}');
   }
   
-  template <typename Iter> inline std::string _parse_number(input<Iter>& in) {
-    std::string num_str;
+  // Characters of a number token. Tokens are short, so they are kept on the
+  // stack; only unusually long ones spill to the heap.
+  class number_str {
+  public:
+    number_str() : len_(0) {
+      buf_[0] = '\0';
+    }
+    void push_back(int ch) {
+      if (len_ + 1 < sizeof(buf_)) {
+        buf_[len_++] = static_cast<char>(ch);
+        buf_[len_] = '\0';
+      } else {
+        if (heap_.empty()) {
+          heap_.assign(buf_, len_);
+        }
+        heap_.push_back(static_cast<char>(ch));
+        len_++;
+      }
+    }
+    const char* c_str() const { return heap_.empty() ? buf_ : heap_.c_str(); }
+    size_t size() const { return len_; }
+    bool empty() const { return len_ == 0; }
+  private:
+    char buf_[64];
+    size_t len_;
+    std::string heap_;
+  };
+
+  template <typename Iter> inline void _parse_number(number_str& out, input<Iter>& in) {
     while (1) {
       int ch = in.getc();
       if (('0' <= ch && ch <= '9') || ch == '+' || ch == '-'
-          || ch == 'e' || ch == 'E') {
-        num_str.push_back(ch);
-      } else if (ch == '.') {
-#if PICOJSON_USE_LOCALE
-        num_str += localeconv()->decimal_point;
-#else
-        num_str.push_back('.');
-#endif
+          || ch == 'e' || ch == 'E' || ch == '.') {
+        out.push_back(ch);
       } else {
 	in.ungetc();
 	break;
       }
     }
-    return num_str;
+  }
+
+  // Converts the common short numbers without strtod (Clinger's fast path):
+  // at most 19 significant digits whose value fits in a double's 53-bit
+  // mantissa, scaled by an exactly representable power of ten. That is a
+  // single correctly rounded operation, so the result is identical to
+  // strtod's. Returns false for anything else, which is then left to strtod.
+  inline bool _parse_double_fast(const char* p, const char* end, double& out) {
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    static const double pow10[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const int max_pow10 = 22;
+    const int max_digits = 19;
+
+    bool negative = false;
+    if (p != end && *p == '-') {
+      negative = true;
+      ++p;
+    }
+    if (p == end) {
+      return false;
+    }
+
+    unsigned long long mantissa = 0;
+    int digits = 0, exponent = 0;
+    if (*p == '0') {
+      ++p;
+    } else if ('1' <= *p && *p <= '9') {
+      do {
+        if (digits++ == max_digits) {
+          return false;
+        }
+        mantissa = mantissa * 10 + (*p++ - '0');
+      } while (p != end && '0' <= *p && *p <= '9');
+    } else {
+      return false;
+    }
+
+    if (p != end && *p == '.') {
+      if (++p == end || ! ('0' <= *p && *p <= '9')) {
+        return false;
+      }
+      do {
+        // Leading zeros of the fraction are not significant digits.
+        if (mantissa != 0 || *p != '0') {
+          if (digits++ == max_digits) {
+            return false;
+          }
+          mantissa = mantissa * 10 + (*p - '0');
+        }
+        exponent--;
+        ++p;
+      } while (p != end && '0' <= *p && *p <= '9');
+    }
+
+    if (p != end && (*p == 'e' || *p == 'E')) {
+      bool negative_exp = false;
+      if (++p != end && (*p == '+' || *p == '-')) {
+        negative_exp = *p++ == '-';
+      }
+      if (p == end || ! ('0' <= *p && *p <= '9')) {
+        return false;
+      }
+      int e = 0;
+      do {
+        if (e < 10000) {
+          e = e * 10 + (*p - '0');
+        }
+        ++p;
+      } while (p != end && '0' <= *p && *p <= '9');
+      exponent += negative_exp ? -e : e;
+    }
+
+    if (p != end || mantissa > (1ULL << 53)) {
+      return false;
+    }
+
+    double value = static_cast<double>(mantissa);
+    if (mantissa != 0) {
+      if (exponent < -max_pow10 || exponent > max_pow10) {
+        return false;
+      }
+      value = exponent < 0 ? value / pow10[-exponent] : value * pow10[exponent];
+    }
+    out = negative ? -value : value;
+    return true;
+#else
+    // Intermediate results may be kept in extended precision, which breaks the
+    // exactness argument above.
+    (void)p;
+    (void)end;
+    (void)out;
+    return false;
+#endif
+  }
+
+  inline bool _parse_double(const number_str& num_str, double& out) {
+    const char* str = num_str.c_str();
+    if (_parse_double_fast(str, str + num_str.size(), out)) {
+      return true;
+    }
+#if PICOJSON_USE_LOCALE
+    // strtod expects the locale's decimal point.
+    std::string localized;
+    const char* point = localeconv()->decimal_point;
+    if (strcmp(point, ".") != 0 && strchr(str, '.') != NULL) {
+      for (const char* p = str; *p != '\0'; ++p) {
+        if (*p == '.') {
+          localized += point;
+        } else {
+          localized.push_back(*p);
+        }
+      }
+      str = localized.c_str();
+    }
+#endif
+    char *endp;
+    out = strtod(str, &endp);
+    return *endp == '\0';
   }
   
   template <typename Context, typename Iter> inline bool _parse(Context& ctx, input<Iter>& in) {
@@ -792,14 +1144,15 @@ namespace picojson {
     default:
       if (('0' <= ch && ch <= '9') || ch == '-') {
         double f;
-        char *endp;
 	in.ungetc();
-        std::string num_str = _parse_number(in);
+        number_str num_str;
+        _parse_number(num_str, in);
         if (num_str.empty()) {
           return false;
         }
 #ifdef PICOJSON_USE_INT64
         {
+          char *endp;
           errno = 0;
           intmax_t ival = strtoimax(num_str.c_str(), &endp, 10);
           if (errno == 0
@@ -811,8 +1164,7 @@ namespace picojson {
           }
         }
 #endif
-        f = strtod(num_str.c_str(), &endp);
-        if (endp == num_str.c_str() + num_str.size()) {
+        if (_parse_double(num_str, f)) {
           ctx.set_number(f);
           return true;
         }
@@ -900,6 +1252,7 @@ namespace picojson {
   public:
     struct dummy_str {
       void push_back(int) {}
+      template <typename Iter> void append(Iter, Iter) {}
     };
   public:
     null_parse_context() {}
@@ -934,20 +1287,27 @@ namespace picojson {
     return err;
   }
   
+  // Describes a syntax error at the current position of `in`, consuming the
+  // rest of the line.
+  template <typename Iter> inline std::string _syntax_error(input<Iter>& in) {
+    char buf[64];
+    SNPRINTF(buf, sizeof(buf), "syntax error at line %d near: ", in.line());
+    std::string err(buf);
+    while (1) {
+      int ch = in.getc();
+      if (ch == -1 || ch == '\n') {
+	break;
+      } else if (ch >= ' ') {
+	err.push_back(ch);
+      }
+    }
+    return err;
+  }
+
   template <typename Context, typename Iter> inline Iter _parse(Context& ctx, const Iter& first, const Iter& last, std::string* err) {
     input<Iter> in(first, last);
     if (! _parse(ctx, in) && err != NULL) {
-      char buf[64];
-      SNPRINTF(buf, sizeof(buf), "syntax error at line %d near: ", in.line());
-      *err = buf;
-      while (1) {
-	int ch = in.getc();
-	if (ch == -1 || ch == '\n') {
-	  break;
-	} else if (ch >= ' ') {
-	  err->push_back(ch);
-	}
-      }
+      *err = _syntax_error(in);
     }
     return in.cur();
   }
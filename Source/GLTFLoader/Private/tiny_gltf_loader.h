@@ -31,6 +31,7 @@
 //
 //
 // Version:
+//  - v0.9.3 Support glTF 2.0 documents and binary glTF 2.0 containers
 //  - v0.9.2 Support parsing `texture`
 //  - v0.9.1 Support loading glTF asset from memory
 //  - v0.9.0 Initial
@@ -47,6 +48,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <functional>
+#include <mutex>
 
 namespace tinygltf {
 
@@ -100,14 +104,26 @@ typedef struct IMAGE {
   int width;
   int height;
   int component;
-  std::vector<unsigned char> image;
+  std::vector<unsigned char> image; // Empty until the image is decoded.
+
+  // Source of the encoded image, recorded at parse time. Images are decoded
+  // on demand by TinyGLTFLoader::DecodeImage.
+  std::string uri; // External file or data URI.
+  int bufferView;  // Set instead of `uri` for images stored in a bufferView
+                   // (glTF 2.0, KHR_binary_glTF), -1 otherwise.
+  std::string mimeType;
+  std::string baseDir; // Directory external files are resolved against.
+
+  IMAGE() : width(0), height(0), component(0), bufferView(-1) {}
+
+  bool decoded() const { return !image.empty(); }
 } Image;
 
 typedef struct TEXTURE {
   int format;
   int internalFormat;
-  std::string sampler; // Required
-  std::string source;  // Required
+  std::string sampler; // Required in glTF 1.0. The index in glTF 2.0.
+  int source;          // Handle of the image, -1 if not set (glTF 2.0).
   int target;
   int type;
   std::string name;
@@ -121,14 +137,15 @@ typedef struct MATERIAL {
 
 typedef struct BUFFERVIEW {
   std::string name;
-  std::string buffer; // Required
+  int buffer;         // Required. Handle of the buffer.
   size_t byteOffset;  // Required
   size_t byteLength;  // default: 0
+  size_t byteStride;  // glTF 2.0. 0 when elements are tightly packed.
   int target;
 } BufferView;
 
 typedef struct ACCESSOR {
-  std::string bufferView;
+  int bufferView; // Handle of the bufferView, -1 if not set (glTF 2.0).
   std::string name;
   size_t byteOffset;
   size_t byteStride;
@@ -137,8 +154,44 @@ typedef struct ACCESSOR {
   int type;                      // One of TINYGLTF_TYPE_***
   std::vector<double> minValues; // Optional
   std::vector<double> maxValues; // Optional
+  bool normalized; // glTF 2.0. Integer components map to [0, 1] / [-1, 1].
 } Accessor;
 
+/// An accessor's elements as located in its buffer, resolved and bounds
+/// checked once all buffers are loaded. Points into the buffers of the Scene
+/// it was resolved for, so it is only valid for that Scene.
+typedef struct ACCESSORVIEW {
+  const unsigned char *data; // First element, NULL if there is none.
+  size_t byteStride;         // Distance between elements, never 0.
+  size_t count;
+  int componentType; // One of TINYGLTF_COMPONENT_TYPE_***
+  int type;          // One of TINYGLTF_TYPE_***
+  bool normalized;   // Integer components map to [0, 1] / [-1, 1].
+
+  ACCESSORVIEW()
+      : data(NULL), byteStride(0), count(0), componentType(0), type(0),
+        normalized(false) {}
+} AccessorView;
+
+/// Copies the first `components` (1 to 4) floats of `count` elements that
+/// start `stride` bytes apart at `data`, such as one attribute of interleaved
+/// vertex data, to `out` one element after another. The floats are copied
+/// bytewise, so they must already be in host byte order. VEC2 to VEC4 are
+/// gathered with SSE or AVX2 when the running CPU has them. Only FLOAT
+/// components are handled: normalized integers go through DecodeNormalized,
+/// and other integer types are left to the caller's per-element conversion.
+void GatherFloats(float *out, const unsigned char *data, size_t count,
+                  size_t stride, int components);
+
+/// Decodes the `components` normalized integers of `count` elements that start
+/// `stride` bytes apart at `data` to floats, one element after another:
+/// unsigned c to c / (2^n - 1) and signed c to max(c / (2^(n-1) - 1), -1) as
+/// in glTF 2.0. Uses SSE2 or AVX2 kernels when the running CPU has them.
+/// Returns false unless `componentType` is an 8 or 16-bit integer type and
+/// `components` is 1 to 4.
+bool DecodeNormalized(float *out, const unsigned char *data, size_t count,
+                      size_t stride, int components, int componentType);
+
 class Camera {
 public:
   Camera() {}
@@ -155,14 +208,12 @@ public:
 };
 
 typedef struct PRIMITIVE {
-  std::map<std::string, std::string> attributes; // A dictionary object of
-                                                 // strings, where each string
-                                                 // is the ID of the accessor
-                                                 // containing an attribute.
-  std::string material; // The ID of the material to apply to this primitive
-                        // when rendering.
-  std::string indices;  // The ID of the accessor that contains the indices.
-  int mode;             // one of TINYGLTF_MODE_***
+  std::map<std::string, int> attributes; // Handle of the accessor containing
+                                         // each attribute.
+  int material; // Handle of the material to apply to this primitive when
+                // rendering, -1 if not set (glTF 2.0) or not loaded.
+  int indices;  // Handle of the accessor that contains the indices, or -1.
+  int mode;     // one of TINYGLTF_MODE_***
 } Primitive;
 
 typedef struct MESH {
@@ -173,22 +224,37 @@ typedef struct MESH {
 class Node {
 public:
   Node() {}
-  ~Node() {}
 
   std::string camera; // camera object referenced by this node.
 
   std::string name;
-  std::vector<std::string> children;
+  std::vector<int> children;       // Node handles.
   std::vector<double> rotation;    // length must be 0 or 4
   std::vector<double> scale;       // length must be 0 or 3
   std::vector<double> translation; // length must be 0 or 3
   std::vector<double> matrix;      // length must be 0 or 16
-  std::vector<std::string> meshes;
+  std::vector<int> meshes;         // Mesh handles; at most one in glTF 2.0.
 };
 
 typedef struct BUFFER {
   std::string name;
-  std::vector<unsigned char> data;
+  std::vector<unsigned char> data; // Owned bytes; empty when `view` is set.
+
+  // Non-owning view of the bytes, e.g. into a mapped file or a caller's
+  // memory. `owner` keeps that memory alive for as long as the buffer refers
+  // to it; if `owner` is empty the caller guarantees the memory outlives the
+  // buffer.
+  const unsigned char *view;
+  size_t viewLength;
+  std::shared_ptr<const void> owner;
+
+  BUFFER() : view(NULL), viewLength(0) {}
+
+  /// Start of the buffer's bytes, wherever they are stored.
+  const unsigned char *bytes() const {
+    return view ? view : (data.empty() ? NULL : &data[0]);
+  }
+  size_t size() const { return view ? viewLength : data.size(); }
 } Buffer;
 
 typedef struct ASSET {
@@ -199,32 +265,299 @@ typedef struct ASSET {
   bool premultipliedAlpha;
 } Asset;
 
+/// Entries of one kind, such as the accessors of a scene, stored contiguously
+/// in document order. Entries refer to each other by handle, which is the
+/// index of an entry in its table; the glTF ids are only needed to look
+/// handles up. glTF 2.0 entries have no ids and are named by their decimal
+/// index instead, so there a handle is the entry's glTF index.
+template <typename T> class SceneTable {
+public:
+  typedef typename std::vector<T>::iterator iterator;
+  typedef typename std::vector<T>::const_iterator const_iterator;
+
+  size_t size() const { return items_.size(); }
+  bool empty() const { return items_.empty(); }
+
+  T &operator[](int handle) { return items_[handle]; }
+  const T &operator[](int handle) const { return items_[handle]; }
+
+  iterator begin() { return items_.begin(); }
+  iterator end() { return items_.end(); }
+  const_iterator begin() const { return items_.begin(); }
+  const_iterator end() const { return items_.end(); }
+
+  /// Returns the glTF id of the entry `handle`.
+  const std::string &name(int handle) const { return names_[handle]; }
+
+  /// Returns the handle of the entry with id `name`, or -1 if there is none.
+  int find(const std::string &name) const {
+    return find(name.data(), name.size());
+  }
+  int find(const char *name, size_t length) const {
+    if (slots_.empty()) {
+      return -1;
+    }
+    return slots_[Probe(name, length, Hash(name, length))];
+  }
+
+  /// Returns the handle of the entry with id `name`, appending a
+  /// default-constructed entry if there is none yet.
+  int intern(const std::string &name) {
+    return intern(name.data(), name.size());
+  }
+  int intern(const char *name, size_t length) {
+    // Keep the id index at most half full.
+    if (2 * (names_.size() + 1) > slots_.size()) {
+      Rehash(slots_.empty() ? 64 : 2 * slots_.size());
+    }
+
+    const size_t hash = Hash(name, length);
+    const size_t slot = Probe(name, length, hash);
+    if (slots_[slot] < 0) {
+      slots_[slot] = static_cast<int>(names_.size());
+      items_.push_back(T());
+      names_.push_back(std::string(name, length));
+      hashes_.push_back(hash);
+    }
+    return slots_[slot];
+  }
+
+  void clear() {
+    items_.clear();
+    names_.clear();
+    hashes_.clear();
+    slots_.clear();
+  }
+
+private:
+  // FNV-1a; ids are short, so this beats anything which needs setup.
+  static size_t Hash(const char *name, size_t length) {
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+      hash = (hash ^ static_cast<unsigned char>(name[i])) * 16777619u;
+    }
+    return hash;
+  }
+
+  // Returns the slot holding `name`, or the empty slot where it would go.
+  size_t Probe(const char *name, size_t length, size_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    size_t slot = hash & mask;
+    for (;;) {
+      const int handle = slots_[slot];
+      if ((handle < 0) ||
+          ((hashes_[handle] == hash) &&
+           (names_[handle].compare(0, std::string::npos, name, length) == 0))) {
+        return slot;
+      }
+      slot = (slot + 1) & mask;
+    }
+  }
+
+  void Rehash(size_t slotCount) {
+    slots_.assign(slotCount, -1);
+    const size_t mask = slotCount - 1;
+    for (size_t i = 0; i < hashes_.size(); i++) {
+      size_t slot = hashes_[i] & mask;
+      while (slots_[slot] >= 0) {
+        slot = (slot + 1) & mask;
+      }
+      slots_[slot] = static_cast<int>(i);
+    }
+  }
+
+  std::vector<T> items_;
+  std::vector<std::string> names_; // glTF id of each entry.
+  std::vector<size_t> hashes_;     // Hash of each id.
+  std::vector<int> slots_;         // Open addressed id index, -1 when free.
+};
+
 class Scene {
 public:
-  Scene() {}
+  Scene() : defaultScene(-1) {}
   ~Scene() {}
 
-  std::map<std::string, Accessor> accessors;
-  std::map<std::string, Buffer> buffers;
-  std::map<std::string, BufferView> bufferViews;
-  std::map<std::string, Material> materials;
-  std::map<std::string, Mesh> meshes;
-  std::map<std::string, Node> nodes;
-  std::map<std::string, Texture> textures;
-  std::map<std::string, Image> images;
-  std::map<std::string, std::vector<std::string> > scenes; // list of nodes
+  SceneTable<Accessor> accessors;
+  SceneTable<Buffer> buffers;
+  SceneTable<BufferView> bufferViews;
+  SceneTable<Material> materials;
+  SceneTable<Mesh> meshes;
+  SceneTable<Node> nodes;
+  SceneTable<Texture> textures;
+  SceneTable<Image> images;
+  SceneTable<std::vector<int> > scenes; // Node handles of each scene.
+
+  std::vector<AccessorView> accessorViews; // Indexed by accessor handle.
 
-  std::string defaultScene;
+  int defaultScene; // Scene handle.
 
   Asset asset;
 };
 
+/// Overview of a glTF document, filled by TinyGLTFLoader::ScanFromFile from
+/// the document structure alone.
+typedef struct SCENESUMMARY {
+  size_t meshes;
+  size_t primitives;
+  size_t nodes;
+  size_t materials;
+  size_t textures;
+  size_t images;
+  size_t accessors;
+  size_t buffers;
+  size_t bufferBytes;   // Sum of the buffers' declared byteLength.
+  size_t accessorBytes; // Sum of count * element size over all accessors.
+  size_t triangles;     // Estimated from the primitives' index or vertex
+                        // counts.
+
+  SCENESUMMARY()
+      : meshes(0), primitives(0), nodes(0), materials(0), textures(0),
+        images(0), accessors(0), buffers(0), bufferBytes(0), accessorBytes(0),
+        triangles(0) {}
+} SceneSummary;
+
+/// Returns the size in bytes of one TINYGLTF_COMPONENT_TYPE_*** component, or
+/// 0 for an unknown component type.
+static inline size_t GetComponentSizeInBytes(int componentType) {
+  switch (componentType) {
+  case TINYGLTF_COMPONENT_TYPE_BYTE:
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+    return 1;
+  case TINYGLTF_COMPONENT_TYPE_SHORT:
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+    return 2;
+  case TINYGLTF_COMPONENT_TYPE_INT:
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+  case TINYGLTF_COMPONENT_TYPE_FLOAT:
+    return 4;
+  case TINYGLTF_COMPONENT_TYPE_DOUBLE:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+/// Returns the number of components of a TINYGLTF_TYPE_*** element, or 0 for
+/// an unknown type.
+static inline size_t GetTypeComponentCount(int type) {
+  switch (type) {
+  case TINYGLTF_TYPE_SCALAR:
+    return 1;
+  case TINYGLTF_TYPE_VEC2:
+    return 2;
+  case TINYGLTF_TYPE_VEC3:
+    return 3;
+  case TINYGLTF_TYPE_VEC4:
+  case TINYGLTF_TYPE_MAT2:
+    return 4;
+  case TINYGLTF_TYPE_MAT3:
+    return 9;
+  case TINYGLTF_TYPE_MAT4:
+    return 16;
+  default:
+    return 0;
+  }
+}
+
+/// Read-only contents of a file. The file is memory-mapped when possible so
+/// its bytes are served straight from the OS page cache; otherwise it is read
+/// into a heap buffer.
+class MappedFile {
+public:
+  MappedFile();
+  ~MappedFile();
+
+  /// Opens `filename` and exposes its contents through `data()`/`size()`.
+  /// If `allowMapping` is false, or the file cannot be mapped, the contents
+  /// are read with buffered I/O instead.
+  /// Returns false and set error string to `err` if there's an error.
+  bool Open(std::string &err, const std::string &filename, bool allowMapping);
+  void Close();
+
+  const unsigned char *data() const { return data_; }
+  size_t size() const { return size_; }
+  bool isMapped() const { return mapped_; }
+
+  /// Asks the OS to start reading a mapped file's pages in the background.
+  /// Returns immediately; the pages stay reclaimable, so large files are not
+  /// forced into memory. Does nothing for buffered reads.
+  void Prefetch() const;
+
+private:
+  MappedFile(const MappedFile &);
+  MappedFile &operator=(const MappedFile &);
+
+  bool Map(const std::string &filename);
+  bool Read(std::string &err, const std::string &filename);
+
+  const unsigned char *data_;
+  size_t size_;
+  bool mapped_;
+  std::vector<unsigned char> buffer_; // Storage for the buffered fallback.
+};
+
+/// Shares external files (buffers and images) between loads, e.g. across the
+/// files of an import batch that reference the same .bin or textures. Files
+/// are keyed by resolved path and stamped with their size and modification
+/// time, so a file that changes on disk is read again and replaces the stale
+/// copy. Cached files stay alive until Clear() is called or the cache is
+/// destroyed, and for as long as a scene uses them.
+/// The cache may be used by several loaders and threads at once.
+class ResourceCache {
+public:
+  /// Opens `filename`, or returns the cached contents if it is unchanged.
+  /// Returns false and set error string to `err` if there's an error.
+  bool Open(std::shared_ptr<MappedFile> &file, std::string &err,
+            const std::string &filename, bool allowMapping);
+
+  /// Releases every cached file.
+  void Clear();
+
+  /// Number of cached files.
+  size_t size();
+
+private:
+  struct Entry {
+    unsigned long long size;
+    long long mtime;
+    std::shared_ptr<MappedFile> file;
+  };
+
+  std::mutex mutex_;
+  std::map<std::string, Entry> files_; // Keyed by resolved path.
+};
+
+class ResourcePrefetcher;
+class EntryParser;
+class SceneParser;
+
 class TinyGLTFLoader {
 public:
-  TinyGLTFLoader(){};
+  /// Runs `task(i)` for every i in [0, count), possibly concurrently, and
+  /// returns once all calls have finished.
+  typedef std::function<void(size_t count,
+                             const std::function<void(size_t)> &task)>
+      ParallelForFunction;
+
+  /// Parts of the document a load reads. Sections outside the profile are
+  /// skipped without being parsed, and their external files are never opened.
+  enum LoadProfile {
+    /// buffers, bufferViews, accessors, meshes, nodes and scenes.
+    LOAD_GEOMETRY,
+    /// LOAD_GEOMETRY plus materials, images and textures.
+    LOAD_GEOMETRY_AND_MATERIALS,
+    /// Everything the loader supports.
+    LOAD_FULL
+  };
+
+  TinyGLTFLoader()
+      : loadProfile_(LOAD_FULL), useMemoryMapping_(true),
+        decodeImagesOnLoad_(false), scanSummary_(NULL), binaryBody_(NULL),
+        binaryBodyLength_(0){};
   ~TinyGLTFLoader(){};
 
-  /// Loads glTF asset from a file.
+  /// Loads glTF asset from a file. Binary glTF (.glb) files are detected by
+  /// their header and loaded with LoadBinaryFromMemory.
   /// Returns false and set error string to `err` if there's an error.
   bool LoadFromFile(Scene &scene, std::string &err,
                     const std::string &filename);
@@ -234,6 +567,88 @@ public:
   /// Returns false and set error string to `err` if there's an error.
   bool LoadFromString(Scene &scene, std::string &err, const char *str,
                       const unsigned int length, const std::string &baseDir);
+
+  /// Loads glTF asset from a binary glTF container in memory, either a
+  /// KHR_binary_glTF (version 1) or a glTF 2.0 one. The container's binary
+  /// body becomes the "binary_glTF" buffer, or buffer 0 in glTF 2.0, without
+  /// being copied, so `bytes` must stay valid for as long as `scene`
+  /// is used, unless `owner` keeps it alive.
+  /// Returns false and set error string to `err` if there's an error.
+  bool LoadBinaryFromMemory(
+      Scene &scene, std::string &err, const unsigned char *bytes,
+      const unsigned int length, const std::string &baseDir,
+      const std::shared_ptr<const void> &owner = std::shared_ptr<const void>());
+
+  /// Summarizes the glTF asset in a file without loading it. Only the JSON
+  /// structure is read: buffers and images are neither opened nor decoded,
+  /// so this is cheap enough to preview an import. Sections outside the load
+  /// profile are not counted.
+  /// Returns false and set error string to `err` if there's an error.
+  bool ScanFromFile(SceneSummary &summary, std::string &err,
+                    const std::string &filename);
+
+  /// Returns true if `bytes` starts with a binary glTF header.
+  static bool IsBinary(const unsigned char *bytes, size_t length);
+
+  /// Decodes the pixels of `image`, which belongs to `scene`, if that has not
+  /// happened yet. Images are only decoded on request unless
+  /// SetDecodeImagesOnLoad is enabled.
+  /// Returns false and set error string to `err` if there's an error.
+  bool DecodeImage(Image &image, std::string &err, const Scene &scene);
+
+  /// Decodes every image of `scene` that has not been decoded yet. Images are
+  /// decoded concurrently on the loader's worker pool; errors are reported in
+  /// image order regardless of which worker finished first.
+  /// Returns false and set error string to `err` if there's an error.
+  bool DecodeImages(Scene &scene, std::string &err);
+
+  /// Sets the worker pool used by the loader's parallel stages, e.g. the
+  /// engine's task system. By default work is spread over std::threads.
+  void SetParallelFor(const ParallelForFunction &parallelFor) {
+    parallelFor_ = parallelFor;
+  }
+
+  /// Selects the sections read by subsequent loads. LOAD_FULL by default.
+  void SetLoadProfile(LoadProfile profile) { loadProfile_ = profile; }
+
+  /// Decode all images while loading instead of on demand. Disabled by
+  /// default so geometry-only imports never pay for image decoding.
+  void SetDecodeImagesOnLoad(bool enabled) { decodeImagesOnLoad_ = enabled; }
+
+  /// Memory-maps the .gltf file and external resources instead of reading
+  /// them into temporary buffers. Enabled by default; buffered reads are used
+  /// whenever a file cannot be mapped.
+  void SetMemoryMapping(bool enabled) { useMemoryMapping_ = enabled; }
+
+  /// Reads external files through `cache`, so they are shared with other
+  /// loads using the same cache. Pass an empty pointer to stop caching.
+  void SetResourceCache(const std::shared_ptr<ResourceCache> &cache) {
+    resourceCache_ = cache;
+  }
+
+private:
+  friend class EntryParser;
+  friend class SceneParser;
+
+  void ParallelFor(size_t count,
+                   const std::function<void(size_t)> &task) const;
+  bool DecodeImages(Scene &scene, std::string &err,
+                    ResourcePrefetcher *prefetcher);
+
+  LoadProfile loadProfile_;
+  bool useMemoryMapping_;
+  bool decodeImagesOnLoad_;
+  std::shared_ptr<ResourceCache> resourceCache_;
+  ParallelForFunction parallelFor_;
+
+  // Set while ScanFromFile runs: loads skip all payloads and add the buffer
+  // sizes to this summary.
+  SceneSummary *scanSummary_;
+
+  // Binary body of the container being loaded by LoadBinaryFromMemory.
+  const unsigned char *binaryBody_;
+  size_t binaryBodyLength_;
+  std::shared_ptr<const void> binaryOwner_;
 };
 
 } // namespace tinygltf
@@ -242,6 +657,14 @@ public:
 #include <sstream>
 #include <fstream>
 #include <cassert>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <utility>
+#include <limits>
+#include <cstdlib>
 
 #include "picojson.h"
 #include "stb_image.h"
@@ -250,1140 +673,4087 @@ public:
 #include <Windows.h>
 #else
 #include <wordexp.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
-using namespace tinygltf;
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) ||             \
+    defined(__i386__)
+#define TINYGLTF_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC allows any intrinsic regardless of the target architecture.
+#define TINYGLTF_TARGET_SSE2
+#define TINYGLTF_TARGET_SSSE3
+#define TINYGLTF_TARGET_SSE41
+#define TINYGLTF_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define TINYGLTF_TARGET_SSE2 __attribute__((target("sse2")))
+#define TINYGLTF_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TINYGLTF_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TINYGLTF_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define TINYGLTF_SIMD_X86 0
+#endif
 
-namespace {
+namespace tinygltf {
 
-bool FileExists(const std::string &abs_filename) {
-  bool ret;
-  FILE *fp = fopen(abs_filename.c_str(), "rb");
-  if (fp) {
-    ret = true;
-    fclose(fp);
-  } else {
-    ret = false;
+/// SIMD instruction sets available at runtime. Kernels compiled for a newer
+/// instruction set than the build targets must check these before running.
+struct CpuFeatures {
+  bool sse2;
+  bool ssse3;
+  bool sse41;
+  bool avx2;
+};
+
+static CpuFeatures DetectCpuFeatures() {
+  CpuFeatures features;
+  features.sse2 = false;
+  features.ssse3 = false;
+  features.sse41 = false;
+  features.avx2 = false;
+
+#if TINYGLTF_SIMD_X86
+  unsigned int a = 0, b = 0, c = 0, d = 0;
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  unsigned int maxLeaf = static_cast<unsigned int>(info[0]);
+  __cpuid(info, 1);
+  c = static_cast<unsigned int>(info[2]);
+  d = static_cast<unsigned int>(info[3]);
+#else
+  unsigned int maxLeaf = __get_cpuid_max(0, NULL);
+  __cpuid(1, a, b, c, d);
+#endif
+  features.sse2 = (d & (1u << 26)) != 0;
+  features.ssse3 = (c & (1u << 9)) != 0;
+  features.sse41 = (c & (1u << 19)) != 0;
+
+  // AVX state must also be enabled by the OS (OSXSAVE and XCR0 bits 1-2).
+  bool osAvx = false;
+  if ((c & (1u << 27)) && (c & (1u << 28))) {
+#ifdef _MSC_VER
+    osAvx = (_xgetbv(0) & 6) == 6;
+#else
+    unsigned int xcr0Lo = 0, xcr0Hi = 0;
+    __asm__("xgetbv" : "=a"(xcr0Lo), "=d"(xcr0Hi) : "c"(0));
+    osAvx = (xcr0Lo & 6) == 6;
+#endif
   }
 
-  return ret;
+  if (osAvx && maxLeaf >= 7) {
+#ifdef _MSC_VER
+    __cpuidex(info, 7, 0);
+    b = static_cast<unsigned int>(info[1]);
+#else
+    __cpuid_count(7, 0, a, b, c, d);
+#endif
+    features.avx2 = (b & (1u << 5)) != 0;
+  }
+#endif
+
+  return features;
 }
 
-std::string ExpandFilePath(const std::string &filepath) {
-#ifdef _WIN32
-  uint32 len = ExpandEnvironmentStringsA(filepath.c_str(), NULL, 0);
-  char *str = new char[len];
-  ExpandEnvironmentStringsA(filepath.c_str(), str, len);
+/// Returns the SIMD instruction sets of the running CPU, detected once.
+const CpuFeatures &GetCpuFeatures() {
+  static const CpuFeatures features = DetectCpuFeatures();
+  return features;
+}
 
-  std::string s(str);
+/// Reads external files (buffers and images) on background threads so their
+/// I/O overlaps with the rest of a load. Readers only block in Wait, when the
+/// bytes are actually consumed. Destroying the prefetcher drops requests that
+/// have not started yet and waits for the ones in flight.
+class ResourcePrefetcher {
+public:
+  ResourcePrefetcher(const std::string &baseDir, bool allowMapping,
+                     ResourceCache *cache);
+  ~ResourcePrefetcher();
+
+  /// Starts reading `uri` unless it is a data URI or was already requested.
+  void Request(const std::string &uri);
+
+  /// Waits for `uri` to be read. Returns false if it was never requested.
+  /// Otherwise `file` holds its contents, or is empty and the read error was
+  /// appended to `err`.
+  bool Wait(std::shared_ptr<MappedFile> &file, std::string &err,
+            const std::string &uri);
+
+private:
+  ResourcePrefetcher(const ResourcePrefetcher &);
+  ResourcePrefetcher &operator=(const ResourcePrefetcher &);
+
+  struct Entry {
+    Entry() : done(false) {}
+
+    bool done;
+    std::shared_ptr<MappedFile> file;
+    std::string err;
+  };
+  typedef std::map<std::string, Entry> EntryMap;
+
+  void Work();
+
+  std::string baseDir_;
+  bool allowMapping_;
+  ResourceCache *cache_;
+
+  std::mutex mutex_;
+  std::condition_variable finished_;
+  EntryMap entries_;
+  std::deque<EntryMap::value_type *> queue_;
+  std::vector<std::thread> threads_;
+  size_t activeWorkers_;
+  bool cancelled_;
+};
 
-  delete[] str;
+/// Bump allocator backing JsonValue trees. Memory is carved out of large
+/// blocks and released all at once. Reset() keeps the regular blocks for
+/// reuse, so parsing one entry after another stops allocating once the arena
+/// has grown to the size of the largest entry.
+class JsonArena {
+public:
+  JsonArena() : block_(0), used_(0) {}
+  ~JsonArena() {
+    Reset();
+    for (size_t i = 0; i < blocks_.size(); i++) {
+      delete[] blocks_[i];
+    }
+  }
 
-  return s;
-#else
+  /// Returns `bytes` bytes of memory aligned for any JSON value.
+  void *Allocate(size_t bytes) {
+    bytes = (bytes + kAlignment - 1) & ~(kAlignment - 1);
+    if (bytes > kBlockSize / 4) {
+      // Large allocations get their own block, freed again by Reset().
+      char *large = new char[bytes];
+      large_.push_back(large);
+      return large;
+    }
 
-#if TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
-  // no expansion
-  std::string s = filepath;
-#else
-  std::string s;
-  wordexp_t p;
+    if (block_ == blocks_.size() || used_ + bytes > kBlockSize) {
+      if (block_ < blocks_.size()) {
+        block_++;
+      }
+      if (block_ == blocks_.size()) {
+        blocks_.push_back(new char[kBlockSize]);
+      }
+      used_ = 0;
+    }
 
-  if (filepath.empty()) {
-    return "";
+    void *p = blocks_[block_] + used_;
+    used_ += bytes;
+    return p;
   }
 
-  // char** w;
-  int ret = wordexp(filepath.c_str(), &p, 0);
-  if (ret) {
-    // err
-    s = filepath;
-    return s;
+  /// Takes ownership of `str`'s buffer and returns its characters. Used for
+  /// strings too large to be worth copying, such as data URIs.
+  const char *Adopt(std::string &str) {
+    adopted_.push_back(std::string());
+    adopted_.back().swap(str);
+    return adopted_.back().data();
   }
 
-  // Use first element only.
-  if (p.we_wordv) {
-    s = std::string(p.we_wordv[0]);
-    wordfree(&p);
-  } else {
-    s = filepath;
+  /// Invalidates everything allocated so far.
+  void Reset() {
+    for (size_t i = 0; i < large_.size(); i++) {
+      delete[] large_[i];
+    }
+    large_.clear();
+    adopted_.clear();
+    block_ = 0;
+    used_ = 0;
   }
 
-#endif
+private:
+  JsonArena(const JsonArena &);
+  JsonArena &operator=(const JsonArena &);
 
-  return s;
-#endif
-}
+  static const size_t kBlockSize = 64 * 1024;
+  static const size_t kAlignment = 8;
 
-std::string JoinPath(const std::string &path0, const std::string &path1) {
-  if (path0.empty()) {
-    return path1;
-  } else {
-    // check '/'
-    char lastChar = *path0.rbegin();
-    if (lastChar != '/') {
-      return path0 + std::string("/") + path1;
-    } else {
-      return path0 + path1;
-    }
-  }
-}
+  std::vector<char *> blocks_; // Regular blocks, reused after Reset().
+  size_t block_;               // Block currently allocated from.
+  size_t used_;                // Bytes used in that block.
+  std::vector<char *> large_;
+  std::deque<std::string> adopted_;
+};
 
-std::string FindFile(const std::vector<std::string> &paths,
-                     const std::string &filepath) {
-  for (size_t i = 0; i < paths.size(); i++) {
-    std::string absPath = ExpandFilePath(JoinPath(paths[i], filepath));
-    if (FileExists(absPath)) {
-      return absPath;
+struct JsonMember;
+
+/// Characters of a JSON string or key, stored in a JsonArena. Not
+/// null-terminated.
+class JsonString {
+public:
+  JsonString() : data_(""), size_(0) {}
+  JsonString(const char *data, size_t size) : data_(data), size_(size) {}
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  std::string str() const { return std::string(data_, size_); }
+
+  /// Returns 0 if the string equals `s`, like std::string::compare.
+  int compare(const char *s) const {
+    size_t length = strlen(s);
+    int ret = memcmp(data_, s, size_ < length ? size_ : length);
+    if (ret != 0) {
+      return ret;
     }
+    return size_ < length ? -1 : (size_ > length ? 1 : 0);
   }
+  int compare(const std::string &s) const { return compare(s.c_str()); }
 
-  return std::string();
-}
+private:
+  const char *data_;
+  size_t size_;
+};
 
-// std::string GetFilePathExtension(const std::string& FileName)
-//{
-//    if(FileName.find_last_of(".") != std::string::npos)
-//        return FileName.substr(FileName.find_last_of(".")+1);
-//    return "";
-//}
+/// A JSON value in a JsonArena. The interface mirrors picojson::value, except
+/// that strings, arrays and objects are returned as views into the arena.
+class JsonValue {
+public:
+  JsonValue() : type_(NULL_TYPE), size_(0), ptr_(NULL), number_(0.0) {}
 
-std::string GetBaseDir(const std::string &filepath) {
-  if (filepath.find_last_of("/\\") != std::string::npos)
-    return filepath.substr(0, filepath.find_last_of("/\\"));
-  return "";
-}
+  static JsonValue Boolean(bool b) {
+    JsonValue v(BOOLEAN_TYPE);
+    v.number_ = b ? 1.0 : 0.0;
+    return v;
+  }
+  static JsonValue Number(double n) {
+    JsonValue v(NUMBER_TYPE);
+    v.number_ = n;
+    return v;
+  }
+  static JsonValue String(const char *data, size_t size) {
+    JsonValue v(STRING_TYPE);
+    v.ptr_ = data;
+    v.size_ = size;
+    return v;
+  }
+  static JsonValue Array(const JsonValue *items, size_t size) {
+    JsonValue v(ARRAY_TYPE);
+    v.ptr_ = items;
+    v.size_ = size;
+    return v;
+  }
+  static JsonValue Object(const JsonMember *members, size_t size) {
+    JsonValue v(OBJECT_TYPE);
+    v.ptr_ = members;
+    v.size_ = size;
+    return v;
+  }
 
-// std::string base64_encode(unsigned char const* , unsigned int len);
-std::string base64_decode(std::string const &s);
+  template <typename T> bool is() const;
+  template <typename T> T get() const;
+
+private:
+  enum Type {
+    NULL_TYPE,
+    BOOLEAN_TYPE,
+    NUMBER_TYPE,
+    STRING_TYPE,
+    ARRAY_TYPE,
+    OBJECT_TYPE
+  };
+
+  explicit JsonValue(Type type)
+      : type_(type), size_(0), ptr_(NULL), number_(0.0) {}
+
+  Type type_;
+  size_t size_;
+  const void *ptr_;
+  double number_;
+};
 
-/*
-   base64.cpp and base64.h
+struct JsonMember {
+  JsonString first;
+  JsonValue second;
+};
+/// Elements of a JSON array.
+class JsonArray {
+public:
+  JsonArray() : items_(NULL), size_(0) {}
+  JsonArray(const JsonValue *items, size_t size)
+      : items_(items), size_(size) {}
 
-   Copyright (C) 2004-2008 René Nyffenegger
+  size_t size() const { return size_; }
+  const JsonValue &operator[](size_t i) const { return items_[i]; }
 
-   This source code is provided 'as-is', without any express or implied
-   warranty. In no event will the author be held liable for any damages
-   arising from the use of this software.
+private:
+  const JsonValue *items_;
+  size_t size_;
+};
 
-   Permission is granted to anyone to use this software for any purpose,
-   including commercial applications, and to alter it and redistribute it
-   freely, subject to the following restrictions:
+/// Members of a JSON object, in document order. Lookups are linear, which is
+/// faster than a tree for the handful of keys glTF objects have.
+class JsonObject {
+public:
+  typedef const JsonMember *const_iterator;
 
-   1. The origin of this source code must not be misrepresented; you must not
-      claim that you wrote the original source code. If you use this source code
-      in a product, an acknowledgment in the product documentation would be
-      appreciated but is not required.
+  JsonObject() : members_(NULL), size_(0) {}
+  JsonObject(const JsonMember *members, size_t size)
+      : members_(members), size_(size) {}
 
-   2. Altered source versions must be plainly marked as such, and must not be
-      misrepresented as being the original source code.
+  size_t size() const { return size_; }
+  const_iterator begin() const { return members_; }
+  const_iterator end() const { return members_ + size_; }
 
-   3. This notice may not be removed or altered from any source distribution.
+  /// Returns the member named `key`, or end(). If a key occurs more than
+  /// once, the last occurrence wins.
+  const_iterator find(const char *key) const;
+  const_iterator find(const std::string &key) const {
+    return find(key.c_str());
+  }
 
-   René Nyffenegger rene.nyffenegger@adp-gmbh.ch
+private:
+  const JsonMember *members_;
+  size_t size_;
+};
 
-*/
 
-//#include "base64.h"
-//#include <iostream>
+template <> inline bool JsonValue::is<bool>() const {
+  return type_ == BOOLEAN_TYPE;
+}
+template <> inline bool JsonValue::is<double>() const {
+  return type_ == NUMBER_TYPE;
+}
+template <> inline bool JsonValue::is<JsonString>() const {
+  return type_ == STRING_TYPE;
+}
+template <> inline bool JsonValue::is<JsonArray>() const {
+  return type_ == ARRAY_TYPE;
+}
+template <> inline bool JsonValue::is<JsonObject>() const {
+  return type_ == OBJECT_TYPE;
+}
 
-static const std::string base64_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-                                        "abcdefghijklmnopqrstuvwxyz"
-                                        "0123456789+/";
+template <> inline bool JsonValue::get<bool>() const {
+  assert(is<bool>());
+  return number_ != 0.0;
+}
+template <> inline double JsonValue::get<double>() const {
+  assert(is<double>());
+  return number_;
+}
+template <> inline JsonString JsonValue::get<JsonString>() const {
+  assert(is<JsonString>());
+  return JsonString(static_cast<const char *>(ptr_), size_);
+}
+template <> inline JsonArray JsonValue::get<JsonArray>() const {
+  assert(is<JsonArray>());
+  return JsonArray(static_cast<const JsonValue *>(ptr_), size_);
+}
+template <> inline JsonObject JsonValue::get<JsonObject>() const {
+  assert(is<JsonObject>());
+  return JsonObject(static_cast<const JsonMember *>(ptr_), size_);
+}
 
-static inline bool is_base64(unsigned char c) {
-  return (isalnum(c) || (c == '+') || (c == '/'));
+inline JsonObject::const_iterator JsonObject::find(const char *key) const {
+  for (size_t i = size_; i > 0; i--) {
+    if (members_[i - 1].first.compare(key) == 0) {
+      return members_ + i - 1;
+    }
+  }
+  return end();
 }
 
-#if 0
-std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
-  std::string ret;
-  int i = 0;
-  int j = 0;
-  unsigned char char_array_3[3];
-  unsigned char char_array_4[4];
+/// Parses JSON into JsonValue trees allocated in a JsonArena, using picojson's
+/// tokenizer through the parse context below. Arrays and objects collect their
+/// elements on scratch stacks and are copied into the arena once complete, so
+/// each one ends up in a single allocation. The scratch stacks are kept
+/// between calls.
+///
+/// When parsing from a character buffer, strings and keys without escape
+/// sequences are not copied at all but point into the buffer, so the buffer
+/// has to outlive the tree.
+class JsonBuilder {
+public:
+  explicit JsonBuilder(JsonArena &arena) : arena_(arena) {}
 
-  while (in_len--) {
-    char_array_3[i++] = *(bytes_to_encode++);
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
+  /// Parses one JSON value from `in` into `out`. Returns false on a syntax
+  /// error; `in` then points at the offending character.
+  template <typename Iter>
+  bool Parse(JsonValue &out, picojson::input<Iter> &in);
 
-      for(i = 0; (i <4) ; i++)
-        ret += base64_chars[char_array_4[i]];
+private:
+  JsonBuilder(const JsonBuilder &);
+  JsonBuilder &operator=(const JsonBuilder &);
+
+  template <typename Iter> friend class JsonParseContext;
+
+  JsonString CopyString(const char *data, size_t size) {
+    char *copy = static_cast<char *>(arena_.Allocate(size));
+    memcpy(copy, data, size);
+    return JsonString(copy, size);
+  }
+
+  // Returns the source characters [first, last) as a JsonString, referencing
+  // them in place when they are stored contiguously.
+  JsonString SourceString(const char *first, const char *last) {
+    return JsonString(first, static_cast<size_t>(last - first));
+  }
+  template <typename Iter> JsonString SourceString(Iter first, Iter last) {
+    chars_.assign(first, last);
+    return CopyString(chars_.data(), chars_.size());
+  }
+
+  template <typename Iter>
+  JsonString Key(const picojson::object_key<Iter> &key) {
+    if (key.is_plain()) {
+      return SourceString(key.begin(), key.end());
+    }
+    const std::string &str = key.str();
+    return CopyString(str.data(), str.size());
+  }
+
+  template <typename Iter>
+  bool ParseString(JsonValue &out, picojson::input<Iter> &in) {
+    Iter first, last;
+    if (in.plain_string(first, last)) {
+      JsonString str = SourceString(first, last);
+      out = JsonValue::String(str.data(), str.size());
+      return true;
+    }
+
+    // Escape sequences need to be decoded into a copy.
+    chars_.clear();
+    if (!picojson::_parse_string(chars_, in)) {
+      return false;
+    }
+
+    if (chars_.size() > kAdoptSize) {
+      size_t size = chars_.size();
+      out = JsonValue::String(arena_.Adopt(chars_), size);
+    } else {
+      JsonString copy = CopyString(chars_.data(), chars_.size());
+      out = JsonValue::String(copy.data(), copy.size());
+    }
+    return true;
+  }
+
+  JsonValue FinishArray(size_t first) {
+    size_t size = items_.size() - first;
+    JsonValue *items = NULL;
+    if (size > 0) {
+      items = static_cast<JsonValue *>(
+          arena_.Allocate(size * sizeof(JsonValue)));
+      std::copy(items_.begin() + first, items_.end(), items);
+      items_.resize(first);
+    }
+    return JsonValue::Array(items, size);
+  }
+
+  JsonValue FinishObject(size_t first) {
+    size_t size = members_.size() - first;
+    JsonMember *members = NULL;
+    if (size > 0) {
+      members = static_cast<JsonMember *>(
+          arena_.Allocate(size * sizeof(JsonMember)));
+      std::copy(members_.begin() + first, members_.end(), members);
+      members_.resize(first);
+    }
+    return JsonValue::Object(members, size);
+  }
+
+  // Strings longer than this are handed to the arena instead of copied.
+  static const size_t kAdoptSize = 4096;
+
+  JsonArena &arena_;
+  std::vector<JsonValue> items_;
+  std::vector<JsonMember> members_;
+  std::string chars_;
+};
+
+/// picojson parse context producing one JsonValue through a JsonBuilder.
+/// picojson reports no end of object, so whoever runs the context calls
+/// Finish() once the value has been parsed.
+template <typename Iter> class JsonParseContext {
+public:
+  JsonParseContext(JsonBuilder &builder, JsonValue &out)
+      : builder_(builder), out_(out), first_(0), isObject_(false) {}
+
+  bool set_null() {
+    out_ = JsonValue();
+    return true;
+  }
+  bool set_bool(bool b) {
+    out_ = JsonValue::Boolean(b);
+    return true;
+  }
+#ifdef PICOJSON_USE_INT64
+  bool set_int64(int64_t i) {
+    out_ = JsonValue::Number(static_cast<double>(i));
+    return true;
+  }
+#endif
+  bool set_number(double f) {
+    out_ = JsonValue::Number(f);
+    return true;
+  }
+  bool parse_string(picojson::input<Iter> &in) {
+    return builder_.ParseString(out_, in);
+  }
+  bool parse_array_start() {
+    first_ = builder_.items_.size();
+    return true;
+  }
+  bool parse_array_item(picojson::input<Iter> &in, size_t) {
+    JsonValue item;
+    if (!ParseChild(item, in)) {
+      return false;
+    }
+    builder_.items_.push_back(item);
+    return true;
+  }
+  bool parse_array_stop(size_t) {
+    out_ = builder_.FinishArray(first_);
+    return true;
+  }
+  bool parse_object_start() {
+    first_ = builder_.members_.size();
+    isObject_ = true;
+    return true;
+  }
+  bool parse_object_item(picojson::input<Iter> &in,
+                         const picojson::object_key<Iter> &key) {
+    JsonMember member;
+    if (!ParseChild(member.second, in)) {
+      return false;
+    }
+    member.first = builder_.Key(key);
+    builder_.members_.push_back(member);
+    return true;
+  }
+
+  void Finish() {
+    if (isObject_) {
+      out_ = builder_.FinishObject(first_);
+    }
+  }
+
+private:
+  JsonParseContext(const JsonParseContext &);
+  JsonParseContext &operator=(const JsonParseContext &);
+
+  bool ParseChild(JsonValue &child, picojson::input<Iter> &in) {
+    JsonParseContext ctx(builder_, child);
+    if (!picojson::_parse(ctx, in)) {
+      return false;
+    }
+    ctx.Finish();
+    return true;
+  }
+
+  JsonBuilder &builder_;
+  JsonValue &out_;
+  size_t first_;  // Start of this container's elements on the scratch stack.
+  bool isObject_;
+};
+
+template <typename Iter>
+bool JsonBuilder::Parse(JsonValue &out, picojson::input<Iter> &in) {
+  items_.clear();
+  members_.clear();
+
+  JsonParseContext<Iter> ctx(*this, out);
+  if (!picojson::_parse(ctx, in)) {
+    return false;
+  }
+  ctx.Finish();
+  return true;
+}
+
+// Top-level dictionaries of a glTF document which hold scene entries. They are
+// ordered so that every load profile reads a prefix of them.
+enum Section {
+  SECTION_BUFFERS,
+  SECTION_BUFFER_VIEWS,
+  SECTION_ACCESSORS,
+  SECTION_MESHES,
+  SECTION_NODES,
+  SECTION_SCENES,
+  SECTION_MATERIALS,
+  SECTION_IMAGES,
+  SECTION_TEXTURES,
+  SECTION_COUNT
+};
+
+static const char *const kSectionNames[SECTION_COUNT] = {
+    "buffers", "bufferViews", "accessors", "meshes",  "nodes",
+    "scenes",  "materials",   "images",    "textures"};
+
+// Number of sections read by each TinyGLTFLoader::LoadProfile.
+static const int kProfileSectionCounts[] = {
+    SECTION_SCENES + 1, // LOAD_GEOMETRY
+    SECTION_COUNT,      // LOAD_GEOMETRY_AND_MATERIALS
+    SECTION_COUNT       // LOAD_FULL
+};
+
+/// Interns the glTF ids of a document into handles of the scene's tables. An
+/// id gets the next slot of its table the first time it is seen, whether it
+/// is defined or referenced first; SceneParser reports ids which end up
+/// referenced without being defined. References into sections outside the
+/// load profile resolve to -1.
+class HandleResolver {
+public:
+  HandleResolver(Scene &scene, int sectionCount)
+      : scene_(scene), sectionCount_(sectionCount), indexed_(false) {
+    for (int i = 0; i < SECTION_COUNT; i++) {
+      referenced_[i] = 0;
+    }
+  }
+
+  /// Whether the document is glTF 2.0, which refers to entries by their index
+  /// in the section's array instead of by id.
+  bool indexed() const { return indexed_; }
+  void SetIndexed(bool indexed) { indexed_ = indexed; }
+
+  int Intern(Section section, const char *id, size_t length) {
+    if (section >= sectionCount_) {
+      return -1;
+    }
+
+    switch (section) {
+    case SECTION_BUFFERS:
+      return scene_.buffers.intern(id, length);
+    case SECTION_BUFFER_VIEWS:
+      return scene_.bufferViews.intern(id, length);
+    case SECTION_ACCESSORS:
+      return scene_.accessors.intern(id, length);
+    case SECTION_MESHES:
+      return scene_.meshes.intern(id, length);
+    case SECTION_NODES:
+      return scene_.nodes.intern(id, length);
+    case SECTION_SCENES:
+      return scene_.scenes.intern(id, length);
+    case SECTION_MATERIALS:
+      return scene_.materials.intern(id, length);
+    case SECTION_IMAGES:
+      return scene_.images.intern(id, length);
+    case SECTION_TEXTURES:
+      return scene_.textures.intern(id, length);
+    default:
+      return -1;
+    }
+  }
+  int Intern(Section section, const std::string &id) {
+    return Intern(section, id.data(), id.size());
+  }
+  int Intern(Section section, const JsonString &id) {
+    return Intern(section, id.data(), id.size());
+  }
+
+  /// Resolves a glTF 2.0 index. An index is its entry's handle already, so
+  /// nothing is interned; the highest one is remembered instead, so that
+  /// SceneParser can report references past the end of a section. Returns
+  /// false if `index` is not a valid array index.
+  bool InternIndex(Section section, double index, int &handle) {
+    if (!(index >= 0.0) || !(index < 2147483647.0)) {
+      return false;
+    }
+    const size_t i = static_cast<size_t>(index);
+    if (static_cast<double>(i) != index) {
+      return false;
+    }
+
+    if (section >= sectionCount_) {
+      handle = -1;
+      return true;
+    }
+
+    if (referenced_[section] <= i) {
+      referenced_[section] = i + 1;
+    }
+    handle = static_cast<int>(i);
+    return true;
+  }
+
+  /// One more than the highest index InternIndex resolved in `section`.
+  size_t referenced(Section section) const { return referenced_[section]; }
+
+  /// Takes over the indices `other` resolved, e.g. while parsing part of the
+  /// same document into another scene.
+  void AddReferences(const HandleResolver &other) {
+    for (int i = 0; i < SECTION_COUNT; i++) {
+      if (referenced_[i] < other.referenced_[i]) {
+        referenced_[i] = other.referenced_[i];
+      }
+    }
+  }
+
+  /// Number of handles in the table of `section`.
+  size_t Size(Section section) const {
+    switch (section) {
+    case SECTION_BUFFERS:
+      return scene_.buffers.size();
+    case SECTION_BUFFER_VIEWS:
+      return scene_.bufferViews.size();
+    case SECTION_ACCESSORS:
+      return scene_.accessors.size();
+    case SECTION_MESHES:
+      return scene_.meshes.size();
+    case SECTION_NODES:
+      return scene_.nodes.size();
+    case SECTION_SCENES:
+      return scene_.scenes.size();
+    case SECTION_MATERIALS:
+      return scene_.materials.size();
+    case SECTION_IMAGES:
+      return scene_.images.size();
+    case SECTION_TEXTURES:
+      return scene_.textures.size();
+    default:
+      return 0;
+    }
+  }
+
+  /// The id `handle` stands for in the table of `section`.
+  const std::string &Name(Section section, int handle) const {
+    switch (section) {
+    case SECTION_BUFFERS:
+      return scene_.buffers.name(handle);
+    case SECTION_BUFFER_VIEWS:
+      return scene_.bufferViews.name(handle);
+    case SECTION_ACCESSORS:
+      return scene_.accessors.name(handle);
+    case SECTION_MESHES:
+      return scene_.meshes.name(handle);
+    case SECTION_NODES:
+      return scene_.nodes.name(handle);
+    case SECTION_SCENES:
+      return scene_.scenes.name(handle);
+    case SECTION_MATERIALS:
+      return scene_.materials.name(handle);
+    case SECTION_IMAGES:
+      return scene_.images.name(handle);
+    default:
+      return scene_.textures.name(handle);
+    }
+  }
+
+private:
+  HandleResolver(const HandleResolver &);
+  HandleResolver &operator=(const HandleResolver &);
+
+  Scene &scene_;
+  int sectionCount_;
+  bool indexed_;
+  size_t referenced_[SECTION_COUNT]; // See InternIndex.
+};
+
+} // namespace tinygltf
+
+using namespace tinygltf;
+
+namespace {
+
+bool FileExists(const std::string &abs_filename) {
+  bool ret;
+  FILE *fp = fopen(abs_filename.c_str(), "rb");
+  if (fp) {
+    ret = true;
+    fclose(fp);
+  } else {
+    ret = false;
+  }
+
+  return ret;
+}
+
+std::string ExpandFilePath(const std::string &filepath) {
+#ifdef _WIN32
+  uint32 len = ExpandEnvironmentStringsA(filepath.c_str(), NULL, 0);
+  char *str = new char[len];
+  ExpandEnvironmentStringsA(filepath.c_str(), str, len);
+
+  std::string s(str);
+
+  delete[] str;
+
+  return s;
+#else
+
+#if TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
+  // no expansion
+  std::string s = filepath;
+#else
+  std::string s;
+  wordexp_t p;
+
+  if (filepath.empty()) {
+    return "";
+  }
+
+  // char** w;
+  int ret = wordexp(filepath.c_str(), &p, 0);
+  if (ret) {
+    // err
+    s = filepath;
+    return s;
+  }
+
+  // Use first element only.
+  if (p.we_wordv) {
+    s = std::string(p.we_wordv[0]);
+    wordfree(&p);
+  } else {
+    s = filepath;
+  }
+
+#endif
+
+  return s;
+#endif
+}
+
+std::string JoinPath(const std::string &path0, const std::string &path1) {
+  if (path0.empty()) {
+    return path1;
+  } else {
+    // check '/'
+    char lastChar = *path0.rbegin();
+    if (lastChar != '/') {
+      return path0 + std::string("/") + path1;
+    } else {
+      return path0 + path1;
+    }
+  }
+}
+
+std::string FindFile(const std::vector<std::string> &paths,
+                     const std::string &filepath) {
+  for (size_t i = 0; i < paths.size(); i++) {
+    std::string absPath = ExpandFilePath(JoinPath(paths[i], filepath));
+    if (FileExists(absPath)) {
+      return absPath;
+    }
+  }
+
+  return std::string();
+}
+
+// std::string GetFilePathExtension(const std::string& FileName)
+//{
+//    if(FileName.find_last_of(".") != std::string::npos)
+//        return FileName.substr(FileName.find_last_of(".")+1);
+//    return "";
+//}
+
+std::string GetBaseDir(const std::string &filepath) {
+  if (filepath.find_last_of("/\\") != std::string::npos)
+    return filepath.substr(0, filepath.find_last_of("/\\"));
+  return "";
+}
+
+/*
+   base64.cpp and base64.h
+
+   Copyright (C) 2004-2008 René Nyffenegger
+
+   This source code is provided 'as-is', without any express or implied
+   warranty. In no event will the author be held liable for any damages
+   arising from the use of this software.
+
+   Permission is granted to anyone to use this software for any purpose,
+   including commercial applications, and to alter it and redistribute it
+   freely, subject to the following restrictions:
+
+   1. The origin of this source code must not be misrepresented; you must not
+      claim that you wrote the original source code. If you use this source code
+      in a product, an acknowledgment in the product documentation would be
+      appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and must not be
+      misrepresented as being the original source code.
+
+   3. This notice may not be removed or altered from any source distribution.
+
+   René Nyffenegger rene.nyffenegger@adp-gmbh.ch
+
+*/
+
+//#include "base64.h"
+//#include <iostream>
+
+static const std::string base64_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                        "abcdefghijklmnopqrstuvwxyz"
+                                        "0123456789+/";
+
+#if 0
+std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
+  std::string ret;
+  int i = 0;
+  int j = 0;
+  unsigned char char_array_3[3];
+  unsigned char char_array_4[4];
+
+  while (in_len--) {
+    char_array_3[i++] = *(bytes_to_encode++);
+    if (i == 3) {
+      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
+      char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
+      char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+      char_array_4[3] = char_array_3[2] & 0x3f;
+
+      for(i = 0; (i <4) ; i++)
+        ret += base64_chars[char_array_4[i]];
       i = 0;
     }
   }
 
-  if (i)
-  {
-    for(j = i; j < 3; j++)
-      char_array_3[j] = '\0';
+  if (i)
+  {
+    for(j = i; j < 3; j++)
+      char_array_3[j] = '\0';
+
+    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
+    char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
+    char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+    char_array_4[3] = char_array_3[2] & 0x3f;
+
+    for (j = 0; (j < i + 1); j++)
+      ret += base64_chars[char_array_4[j]];
+
+    while((i++ < 3))
+      ret += '=';
+
+  }
+
+  return ret;
+
+}
+#endif
+
+// Table-driven decoder. The original character-at-a-time loop (with a
+// base64_chars.find() per symbol and a growing std::string) was replaced by a
+// lookup table, SSSE3/AVX2 block decoders and a pre-sized output. Decoding
+// still stops at the first '=' or non-base64 character, and never writes more
+// than the capacity of the output.
+
+static const unsigned char base64_invalid = 0xff;
+
+struct base64_table {
+  unsigned char values[256];
+
+  base64_table() {
+    memset(values, base64_invalid, sizeof(values));
+    for (unsigned char i = 0; i < 64; i++) {
+      values[static_cast<unsigned char>(base64_chars[i])] = i;
+    }
+  }
+};
+
+static const base64_table base64_lookup;
+
+// Upper bound of the number of bytes decoded from `len` characters.
+size_t base64_decoded_size(const char *in, size_t len) {
+  while (len > 0 && in[len - 1] == '=') {
+    len--;
+  }
+  return (len / 4) * 3 + ((len % 4) * 3) / 4;
+}
+
+// Checks that [in, in + len) ends in canonical padding: at most two '=', only
+// after a whole number of quads, and no lone trailing character.
+bool base64_padding_valid(const char *in, size_t len) {
+  size_t padding = 0;
+  while (padding < len && in[len - padding - 1] == '=') {
+    padding++;
+  }
+  if (padding > 2 || (padding > 0 && (len % 4) != 0)) {
+    return false;
+  }
+  return ((len - padding) % 4) != 1;
+}
+
+// Decodes characters [in, in + len) until a terminating character or until
+// `capacity` bytes are written. Returns the number of characters consumed and
+// sets `written` to the bytes written.
+size_t base64_decode_scalar(unsigned char *out, size_t capacity,
+                            const char *in, size_t len, size_t &written) {
+  const unsigned char *values = base64_lookup.values;
+  size_t i = 0;
+  size_t o = 0;
+
+  for (; (i + 4 <= len) && (o + 3 <= capacity); i += 4) {
+    unsigned int a = values[static_cast<unsigned char>(in[i])];
+    unsigned int b = values[static_cast<unsigned char>(in[i + 1])];
+    unsigned int c = values[static_cast<unsigned char>(in[i + 2])];
+    unsigned int d = values[static_cast<unsigned char>(in[i + 3])];
+    if ((a | b | c | d) & 0x80) {
+      break;
+    }
+    unsigned int n = (a << 18) | (b << 12) | (c << 6) | d;
+    out[o++] = static_cast<unsigned char>(n >> 16);
+    out[o++] = static_cast<unsigned char>(n >> 8);
+    out[o++] = static_cast<unsigned char>(n);
+  }
+
+  // Tail, or a quad holding a terminating character.
+  unsigned int n = 0;
+  int bits = 0;
+  for (; i < len; i++) {
+    unsigned int v = values[static_cast<unsigned char>(in[i])];
+    if (v == base64_invalid) {
+      break;
+    }
+    n = (n << 6) | v;
+    bits += 6;
+    if (bits >= 8) {
+      if (o == capacity) {
+        break;
+      }
+      bits -= 8;
+      out[o++] = static_cast<unsigned char>(n >> bits);
+    }
+  }
+
+  written = o;
+  return i;
+}
+
+#if TINYGLTF_SIMD_X86
+
+// Vectorized decoding after W. Mula and D. Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions". Each block of characters is validated and
+// translated with nibble lookups, then packed from 6 to 8 bits per byte. A
+// block containing any other character is left to the scalar decoder, as is
+// the end of the output where a full vector store would not fit.
+
+TINYGLTF_TARGET_SSSE3
+size_t base64_decode_ssse3(unsigned char *out, size_t capacity,
+                           const char *in, size_t len, size_t &written) {
+  const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                      0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b,
+                                      0x1b, 0x1a);
+  const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04,
+                                      0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                      0x10, 0x10);
+  const __m128i lutRoll =
+      _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i nibbleMask = _mm_set1_epi8(0x0f);
+  const __m128i slash = _mm_set1_epi8(0x2f);
+  const __m128i packPairs = _mm_set1_epi32(0x01400140);
+  const __m128i packQuads = _mm_set1_epi32(0x00011000);
+  const __m128i packBytes =
+      _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+  size_t i = 0;
+  size_t o = 0;
+
+  // Each 16-byte store writes 4 bytes past the 12 decoded ones, so stop once
+  // a full store would not fit in the output.
+  for (; (i + 16 <= len) && (o + 16 <= capacity); i += 16, o += 12) {
+    __m128i input =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(input, 4), nibbleMask);
+    __m128i loNibbles = _mm_and_si128(input, nibbleMask);
+    __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+    __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+    if (_mm_movemask_epi8(
+            _mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128()))) {
+      break;
+    }
+    __m128i isSlash = _mm_cmpeq_epi8(input, slash);
+    __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(isSlash, hiNibbles));
+    __m128i values = _mm_add_epi8(input, roll);
+
+    __m128i pairs = _mm_maddubs_epi16(values, packPairs);
+    __m128i quads = _mm_madd_epi16(pairs, packQuads);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + o),
+                     _mm_shuffle_epi8(quads, packBytes));
+  }
+
+  size_t tail = 0;
+  i += base64_decode_scalar(out + o, capacity - o, in + i, len - i, tail);
+  written = o + tail;
+  return i;
+}
+
+TINYGLTF_TARGET_AVX2
+size_t base64_decode_avx2(unsigned char *out, size_t capacity,
+                          const char *in, size_t len, size_t &written) {
+  const __m256i lutLo = _mm256_setr_epi8(
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a,
+      0x1b, 0x1b, 0x1b, 0x1a, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m256i lutHi = _mm256_setr_epi8(
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lutRoll = _mm256_setr_epi8(
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4,
+      -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i nibbleMask = _mm256_set1_epi8(0x0f);
+  const __m256i slash = _mm256_set1_epi8(0x2f);
+  const __m256i packPairs = _mm256_set1_epi32(0x01400140);
+  const __m256i packQuads = _mm256_set1_epi32(0x00011000);
+  const __m256i packBytes = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5,
+      4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const __m256i packLanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+  size_t i = 0;
+  size_t o = 0;
+
+  // Each 32-byte store writes 8 bytes past the 24 decoded ones, so stop once
+  // a full store would not fit in the output.
+  for (; (i + 32 <= len) && (o + 32 <= capacity); i += 32, o += 24) {
+    __m256i input =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    __m256i hiNibbles =
+        _mm256_and_si256(_mm256_srli_epi32(input, 4), nibbleMask);
+    __m256i loNibbles = _mm256_and_si256(input, nibbleMask);
+    __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+    __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+    if (!_mm256_testz_si256(lo, hi)) {
+      break;
+    }
+    __m256i isSlash = _mm256_cmpeq_epi8(input, slash);
+    __m256i roll =
+        _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(isSlash, hiNibbles));
+    __m256i values = _mm256_add_epi8(input, roll);
+
+    __m256i pairs = _mm256_maddubs_epi16(values, packPairs);
+    __m256i quads = _mm256_madd_epi16(pairs, packQuads);
+    __m256i packed = _mm256_permutevar8x32_epi32(
+        _mm256_shuffle_epi8(quads, packBytes), packLanes);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + o), packed);
+  }
+
+  size_t tail = 0;
+  i += base64_decode_ssse3(out + o, capacity - o, in + i, len - i, tail);
+  written = o + tail;
+  return i;
+}
+
+#endif // TINYGLTF_SIMD_X86
+
+// Decodes [in, in + len) into `out`, which has room for `capacity` bytes
+// (base64_decoded_size(in, len) holds the whole payload). Returns the number
+// of bytes written, or 0 when the padding is malformed.
+size_t base64_decode_into(unsigned char *out, size_t capacity, const char *in,
+                          size_t len) {
+  size_t written = 0;
+  if (!base64_padding_valid(in, len)) {
+    return 0;
+  }
+#if TINYGLTF_SIMD_X86
+  const CpuFeatures &cpu = GetCpuFeatures();
+  if (cpu.avx2) {
+    base64_decode_avx2(out, capacity, in, len, written);
+    return written;
+  }
+  if (cpu.ssse3) {
+    base64_decode_ssse3(out, capacity, in, len, written);
+    return written;
+  }
+#endif
+  base64_decode_scalar(out, capacity, in, len, written);
+  return written;
+}
+
+void GatherFloatsScalar(float *out, const unsigned char *data, size_t count,
+                        size_t stride, int components) {
+  const size_t size = components * sizeof(float);
+  for (size_t i = 0; i < count; i++, data += stride, out += components) {
+    memcpy(out, data, size);
+  }
+}
+
+#if TINYGLTF_SIMD_X86
+
+// Deinterleaving kernels for float VEC2, VEC3 and VEC4, 4 (SSE2) or 8 (AVX2)
+// elements per step. VEC3 elements are loaded as 16 bytes, which reads into
+// the next element, so the last element is always left to the scalar tail.
+
+TINYGLTF_TARGET_SSE2
+size_t GatherFloatsSSE2(float *out, const unsigned char *data, size_t count,
+                        size_t stride, int components) {
+#define TINYGLTF_ELEMENT(k)                                                    \
+  reinterpret_cast<const float *>(data + (i + (k)) * stride)
+  size_t i = 0;
+  switch (components) {
+  case 2:
+    for (; i + 4 <= count; i += 4, out += 8) {
+      __m128 ab = _mm_loadh_pi(
+          _mm_loadl_pi(_mm_setzero_ps(),
+                       reinterpret_cast<const __m64 *>(TINYGLTF_ELEMENT(0))),
+          reinterpret_cast<const __m64 *>(TINYGLTF_ELEMENT(1)));
+      __m128 cd = _mm_loadh_pi(
+          _mm_loadl_pi(_mm_setzero_ps(),
+                       reinterpret_cast<const __m64 *>(TINYGLTF_ELEMENT(2))),
+          reinterpret_cast<const __m64 *>(TINYGLTF_ELEMENT(3)));
+      _mm_storeu_ps(out, ab);
+      _mm_storeu_ps(out + 4, cd);
+    }
+    break;
+  case 3:
+    for (; i + 4 < count; i += 4, out += 12) {
+      __m128 a = _mm_loadu_ps(TINYGLTF_ELEMENT(0));
+      __m128 b = _mm_loadu_ps(TINYGLTF_ELEMENT(1));
+      __m128 c = _mm_loadu_ps(TINYGLTF_ELEMENT(2));
+      __m128 d = _mm_loadu_ps(TINYGLTF_ELEMENT(3));
+      // a0 a1 a2 b0 | b1 b2 c0 c1 | c2 d0 d1 d2
+      __m128 a2b0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 2, 2));
+      __m128 c2d0 = _mm_shuffle_ps(c, d, _MM_SHUFFLE(0, 0, 2, 2));
+      _mm_storeu_ps(out, _mm_shuffle_ps(a, a2b0, _MM_SHUFFLE(2, 0, 1, 0)));
+      _mm_storeu_ps(out + 4, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 2, 1)));
+      _mm_storeu_ps(out + 8, _mm_shuffle_ps(c2d0, d, _MM_SHUFFLE(2, 1, 2, 0)));
+    }
+    break;
+  case 4:
+    for (; i + 4 <= count; i += 4, out += 16) {
+      _mm_storeu_ps(out, _mm_loadu_ps(TINYGLTF_ELEMENT(0)));
+      _mm_storeu_ps(out + 4, _mm_loadu_ps(TINYGLTF_ELEMENT(1)));
+      _mm_storeu_ps(out + 8, _mm_loadu_ps(TINYGLTF_ELEMENT(2)));
+      _mm_storeu_ps(out + 12, _mm_loadu_ps(TINYGLTF_ELEMENT(3)));
+    }
+    break;
+  }
+#undef TINYGLTF_ELEMENT
+  return i;
+}
+
+TINYGLTF_TARGET_AVX2
+size_t GatherFloatsAVX2(float *out, const unsigned char *data, size_t count,
+                        size_t stride, int components) {
+#define TINYGLTF_ELEMENT(k)                                                    \
+  reinterpret_cast<const float *>(data + (i + (k)) * stride)
+#define TINYGLTF_PAIR(k)                                                       \
+  _mm256_insertf128_ps(                                                        \
+      _mm256_castps128_ps256(_mm_loadu_ps(TINYGLTF_ELEMENT(k))),               \
+      _mm_loadu_ps(TINYGLTF_ELEMENT((k) + 4)), 1)
+  size_t i = 0;
+  switch (components) {
+  case 2:
+    for (; i + 8 <= count; i += 8, out += 16) {
+      __m128 v[4];
+      for (int k = 0; k < 4; k++) {
+        v[k] = _mm_loadh_pi(
+            _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(
+                                               TINYGLTF_ELEMENT(2 * k))),
+            reinterpret_cast<const __m64 *>(TINYGLTF_ELEMENT(2 * k + 1)));
+      }
+      _mm256_storeu_ps(out, _mm256_insertf128_ps(_mm256_castps128_ps256(v[0]),
+                                                 v[1], 1));
+      _mm256_storeu_ps(out + 8, _mm256_insertf128_ps(
+                                    _mm256_castps128_ps256(v[2]), v[3], 1));
+    }
+    break;
+  case 3:
+    // Elements 0-3 in the low lanes, 4-7 in the high lanes, shuffled as in
+    // the SSE2 kernel and then put back in order.
+    for (; i + 8 < count; i += 8, out += 24) {
+      __m256 a = TINYGLTF_PAIR(0);
+      __m256 b = TINYGLTF_PAIR(1);
+      __m256 c = TINYGLTF_PAIR(2);
+      __m256 d = TINYGLTF_PAIR(3);
+      __m256 a2b0 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 2, 2));
+      __m256 c2d0 = _mm256_shuffle_ps(c, d, _MM_SHUFFLE(0, 0, 2, 2));
+      __m256 r0 = _mm256_shuffle_ps(a, a2b0, _MM_SHUFFLE(2, 0, 1, 0));
+      __m256 r1 = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 2, 1));
+      __m256 r2 = _mm256_shuffle_ps(c2d0, d, _MM_SHUFFLE(2, 1, 2, 0));
+      _mm256_storeu_ps(out, _mm256_permute2f128_ps(r0, r1, 0x20));
+      _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(r2, r0, 0x30));
+      _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(r1, r2, 0x31));
+    }
+    break;
+  case 4:
+    for (; i + 8 <= count; i += 8, out += 32) {
+      for (int k = 0; k < 4; k++) {
+        _mm256_storeu_ps(out + 8 * k,
+                         _mm256_insertf128_ps(
+                             _mm256_castps128_ps256(
+                                 _mm_loadu_ps(TINYGLTF_ELEMENT(2 * k))),
+                             _mm_loadu_ps(TINYGLTF_ELEMENT(2 * k + 1)), 1));
+      }
+    }
+    break;
+  }
+#undef TINYGLTF_PAIR
+#undef TINYGLTF_ELEMENT
+  return i;
+}
+
+#endif // TINYGLTF_SIMD_X86
+
+template <typename T> T ReadLittleEndian(const unsigned char *p) {
+  unsigned int value = 0;
+  for (size_t i = 0; i < sizeof(T); i++) {
+    value |= static_cast<unsigned int>(p[i]) << (8 * i);
+  }
+  return static_cast<T>(value);
+}
+
+// Normalized values are divided by the largest value of their type.
+template <typename T> float NormalizedDivisor() {
+  // Parenthesized against the max macro of <Windows.h>.
+  return static_cast<float>((std::numeric_limits<T>::max)());
+}
+
+template <typename T>
+void DecodeNormalizedScalar(float *out, const unsigned char *in, size_t n) {
+  const float divisor = NormalizedDivisor<T>();
+  for (size_t i = 0; i < n; i++) {
+    float value = ReadLittleEndian<T>(in + i * sizeof(T)) / divisor;
+    out[i] = (value < -1.0f) ? -1.0f : value;
+  }
+}
+
+#if TINYGLTF_SIMD_X86
+
+// Normalized-integer kernels over packed components: widen to 32 bits,
+// convert and divide, 16 (bytes) or 8 (shorts) components per step. x86 is
+// little endian, so components are loaded as they are.
+
+TINYGLTF_TARGET_SSE2
+void StoreNormalizedSSE2(float *out, __m128i values, __m128 divisor) {
+  _mm_storeu_ps(out, _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(values), divisor),
+                                _mm_set1_ps(-1.0f)));
+}
+
+TINYGLTF_TARGET_SSE2
+size_t DecodeNormalizedSSE2(float *out, const unsigned char *in, size_t n,
+                            int componentType) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  switch (componentType) {
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+    const __m128 divisor = _mm_set1_ps(NormalizedDivisor<unsigned char>());
+    for (; i + 16 <= n; i += 16) {
+      __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+      __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+      __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+      StoreNormalizedSSE2(out + i, _mm_unpacklo_epi16(lo, zero), divisor);
+      StoreNormalizedSSE2(out + i + 4, _mm_unpackhi_epi16(lo, zero), divisor);
+      StoreNormalizedSSE2(out + i + 8, _mm_unpacklo_epi16(hi, zero), divisor);
+      StoreNormalizedSSE2(out + i + 12, _mm_unpackhi_epi16(hi, zero), divisor);
+    }
+    break;
+  }
+  case TINYGLTF_COMPONENT_TYPE_BYTE: {
+    // Sign extension: move each byte to the top of a wider lane, then shift
+    // it back down arithmetically.
+    const __m128 divisor = _mm_set1_ps(NormalizedDivisor<signed char>());
+    for (; i + 16 <= n; i += 16) {
+      __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+      __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(zero, bytes), 8);
+      __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(zero, bytes), 8);
+      StoreNormalizedSSE2(out + i,
+                          _mm_srai_epi32(_mm_unpacklo_epi16(zero, lo), 16),
+                          divisor);
+      StoreNormalizedSSE2(out + i + 4,
+                          _mm_srai_epi32(_mm_unpackhi_epi16(zero, lo), 16),
+                          divisor);
+      StoreNormalizedSSE2(out + i + 8,
+                          _mm_srai_epi32(_mm_unpacklo_epi16(zero, hi), 16),
+                          divisor);
+      StoreNormalizedSSE2(out + i + 12,
+                          _mm_srai_epi32(_mm_unpackhi_epi16(zero, hi), 16),
+                          divisor);
+    }
+    break;
+  }
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+    const __m128 divisor = _mm_set1_ps(NormalizedDivisor<unsigned short>());
+    for (; i + 8 <= n; i += 8) {
+      __m128i shorts =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * i));
+      StoreNormalizedSSE2(out + i, _mm_unpacklo_epi16(shorts, zero), divisor);
+      StoreNormalizedSSE2(out + i + 4, _mm_unpackhi_epi16(shorts, zero),
+                          divisor);
+    }
+    break;
+  }
+  case TINYGLTF_COMPONENT_TYPE_SHORT: {
+    const __m128 divisor = _mm_set1_ps(NormalizedDivisor<short>());
+    for (; i + 8 <= n; i += 8) {
+      __m128i shorts =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * i));
+      StoreNormalizedSSE2(out + i,
+                          _mm_srai_epi32(_mm_unpacklo_epi16(zero, shorts), 16),
+                          divisor);
+      StoreNormalizedSSE2(out + i + 4,
+                          _mm_srai_epi32(_mm_unpackhi_epi16(zero, shorts), 16),
+                          divisor);
+    }
+    break;
+  }
+  }
+  return i;
+}
+
+TINYGLTF_TARGET_AVX2
+void StoreNormalizedAVX2(float *out, __m256i values, __m256 divisor) {
+  _mm256_storeu_ps(out, _mm256_max_ps(_mm256_div_ps(_mm256_cvtepi32_ps(values),
+                                                    divisor),
+                                      _mm256_set1_ps(-1.0f)));
+}
+
+TINYGLTF_TARGET_AVX2
+size_t DecodeNormalizedAVX2(float *out, const unsigned char *in, size_t n,
+                            int componentType) {
+  size_t i = 0;
+  switch (componentType) {
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+    const __m256 divisor = _mm256_set1_ps(NormalizedDivisor<unsigned char>());
+    for (; i + 16 <= n; i += 16) {
+      __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+      StoreNormalizedAVX2(out + i, _mm256_cvtepu8_epi32(bytes), divisor);
+      StoreNormalizedAVX2(out + i + 8,
+                          _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)),
+                          divisor);
+    }
+    break;
+  }
+  case TINYGLTF_COMPONENT_TYPE_BYTE: {
+    const __m256 divisor = _mm256_set1_ps(NormalizedDivisor<signed char>());
+    for (; i + 16 <= n; i += 16) {
+      __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+      StoreNormalizedAVX2(out + i, _mm256_cvtepi8_epi32(bytes), divisor);
+      StoreNormalizedAVX2(out + i + 8,
+                          _mm256_cvtepi8_epi32(_mm_srli_si128(bytes, 8)),
+                          divisor);
+    }
+    break;
+  }
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+    const __m256 divisor = _mm256_set1_ps(NormalizedDivisor<unsigned short>());
+    for (; i + 8 <= n; i += 8) {
+      __m128i shorts =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * i));
+      StoreNormalizedAVX2(out + i, _mm256_cvtepu16_epi32(shorts), divisor);
+    }
+    break;
+  }
+  case TINYGLTF_COMPONENT_TYPE_SHORT: {
+    const __m256 divisor = _mm256_set1_ps(NormalizedDivisor<short>());
+    for (; i + 8 <= n; i += 8) {
+      __m128i shorts =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * i));
+      StoreNormalizedAVX2(out + i, _mm256_cvtepi16_epi32(shorts), divisor);
+    }
+    break;
+  }
+  }
+  return i;
+}
+
+#endif // TINYGLTF_SIMD_X86
+
+// Copies `n` elements of Size bytes that are `stride` apart to `out`, packed.
+template <size_t Size>
+void PackElements(unsigned char *out, const unsigned char *data, size_t n,
+                  size_t stride) {
+  for (size_t i = 0; i < n; i++, out += Size, data += stride) {
+    memcpy(out, data, Size);
+  }
+}
+
+// Decodes `n` packed normalized components of `componentType`.
+void DecodeNormalizedRun(float *out, const unsigned char *in, size_t n,
+                         int componentType) {
+  const size_t size = GetComponentSizeInBytes(componentType);
+  size_t done = 0;
+#if TINYGLTF_SIMD_X86
+  const CpuFeatures &cpu = GetCpuFeatures();
+  if (cpu.avx2) {
+    done = DecodeNormalizedAVX2(out, in, n, componentType);
+  }
+  if (cpu.sse2) {
+    done += DecodeNormalizedSSE2(out + done, in + done * size, n - done,
+                                 componentType);
+  }
+#endif
+  out += done;
+  in += done * size;
+  n -= done;
+  switch (componentType) {
+  case TINYGLTF_COMPONENT_TYPE_BYTE:
+    DecodeNormalizedScalar<signed char>(out, in, n);
+    break;
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+    DecodeNormalizedScalar<unsigned char>(out, in, n);
+    break;
+  case TINYGLTF_COMPONENT_TYPE_SHORT:
+    DecodeNormalizedScalar<short>(out, in, n);
+    break;
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+    DecodeNormalizedScalar<unsigned short>(out, in, n);
+    break;
+  }
+}
+
+unsigned int ReadLittleEndianU32(const unsigned char *p) {
+  return static_cast<unsigned int>(p[0]) |
+         (static_cast<unsigned int>(p[1]) << 8) |
+         (static_cast<unsigned int>(p[2]) << 16) |
+         (static_cast<unsigned int>(p[3]) << 24);
+}
+
+// Returns the absolute path of `filename` with "." and ".." resolved, so
+// different relative paths to one file compare equal. Falls back to
+// `filename` if it cannot be resolved.
+std::string ResolvePath(const std::string &filename) {
+#ifdef _WIN32
+  DWORD length = GetFullPathNameA(filename.c_str(), 0, NULL, NULL);
+  if (length == 0) {
+    return filename;
+  }
+  std::string path(length, '\0');
+  length = GetFullPathNameA(filename.c_str(), length, &path[0], NULL);
+  if ((length == 0) || (length >= path.size())) {
+    return filename;
+  }
+  path.resize(length);
+  return path;
+#else
+  char *resolved = realpath(filename.c_str(), NULL);
+  if (!resolved) {
+    return filename;
+  }
+  std::string path(resolved);
+  free(resolved);
+  return path;
+#endif
+}
+
+// Returns the size and modification time of `filename`. The time is in
+// 100 ns units on Windows and in nanoseconds elsewhere.
+bool GetFileStamp(const std::string &filename, unsigned long long &size,
+                  long long &mtime) {
+#ifdef _WIN32
+  WIN32_FILE_ATTRIBUTE_DATA attributes;
+  if (!GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard,
+                            &attributes)) {
+    return false;
+  }
+  size = (static_cast<unsigned long long>(attributes.nFileSizeHigh) << 32) |
+         attributes.nFileSizeLow;
+  mtime = (static_cast<long long>(attributes.ftLastWriteTime.dwHighDateTime)
+           << 32) |
+          attributes.ftLastWriteTime.dwLowDateTime;
+#else
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0) {
+    return false;
+  }
+  size = static_cast<unsigned long long>(st.st_size);
+#ifdef __APPLE__
+  const struct timespec &modified = st.st_mtimespec;
+#else
+  const struct timespec &modified = st.st_mtim;
+#endif
+  mtime = static_cast<long long>(modified.tv_sec) * 1000000000LL +
+          modified.tv_nsec;
+#endif
+  return true;
+}
+
+// Takes the file from `prefetcher` when it was requested there, otherwise
+// reads it synchronously, through `cache` if there is one.
+bool LoadExternalFile(std::shared_ptr<MappedFile> &out, std::string &err,
+                      const std::string &filename, const std::string &basedir,
+                      size_t reqBytes, bool checkSize, bool allowMapping,
+                      ResourceCache *cache,
+                      ResourcePrefetcher *prefetcher = NULL) {
+  out.reset();
+
+  std::shared_ptr<MappedFile> f;
+  if (prefetcher && prefetcher->Wait(f, err, filename)) {
+    if (!f) {
+      return false;
+    }
+  } else {
+    std::vector<std::string> paths;
+    paths.push_back(basedir);
+    paths.push_back(".");
+
+    std::string filepath = FindFile(paths, filename);
+    if (filepath.empty()) {
+      err += "File not found : " + filename;
+      return false;
+    }
+
+    if (cache) {
+      if (!cache->Open(f, err, filepath, allowMapping)) {
+        return false;
+      }
+    } else {
+      f.reset(new MappedFile);
+      if (!f->Open(err, filepath, allowMapping)) {
+        return false;
+      }
+    }
+  }
+
+  size_t sz = f->size();
+  if (checkSize && reqBytes != sz) {
+    std::stringstream ss;
+    ss << "File size mismatch : " << filename << ", requestedBytes "
+       << reqBytes << ", but got " << sz << std::endl;
+    err += ss.str();
+    return false;
+  }
+
+  out = f;
+  return true;
+}
+
+// Returns the length of the "data:<mime>;base64," header if the `size`
+// characters at `in` are a supported data URI, or 0 otherwise.
+size_t DataURIHeaderLength(const char *in, size_t size) {
+  static const char *const headers[] = {
+      "data:application/octet-stream;base64,",
+      "data:application/gltf-buffer;base64,", "data:image/png;base64,",
+      "data:image/jpeg;base64,"};
+
+  for (size_t i = 0; i < sizeof(headers) / sizeof(headers[0]); i++) {
+    size_t length = strlen(headers[i]);
+    if ((size >= length) && (memcmp(in, headers[i], length) == 0)) {
+      return length;
+    }
+  }
+
+  return 0;
+}
+
+size_t DataURIHeaderLength(const std::string &in) {
+  return DataURIHeaderLength(in.data(), in.size());
+}
+
+// Decodes the base64 payload of a data URI (the characters following its
+// header) straight into `out`. `out` is sized once up front: to `reqBytes`
+// when `checkSize` is set, otherwise to the length implied by the payload.
+// The decoders never write past that size, and payloads with malformed
+// padding are rejected before anything is allocated.
+bool DecodeDataURI(std::vector<unsigned char> &out, const char *payload,
+                   size_t length, size_t reqBytes, bool checkSize) {
+  if (!base64_padding_valid(payload, length)) {
+    return false;
+  }
+
+  size_t bytes = base64_decoded_size(payload, length);
+  if (bytes == 0 || (checkSize && bytes != reqBytes)) {
+    return false;
+  }
+
+  out.resize(bytes);
+  size_t written = base64_decode_into(&out.at(0), out.size(), payload, length);
+  if (written == 0 || (checkSize && written != reqBytes)) {
+    return false;
+  }
+
+  out.resize(written);
+  return true;
+}
+
+bool ParseBooleanProperty(bool &ret, std::string &err,
+                          const JsonObject &o,
+                          const std::string &property, bool required) {
+  JsonObject::const_iterator it = o.find(property);
+  if (it == o.end()) {
+    if (required) {
+      err += "'" + property + "' property is missing.\n";
+    }
+    return false;
+  }
+
+  if (!it->second.is<bool>()) {
+    if (required) {
+      err += "'" + property + "' property is not a bool type.\n";
+    }
+    return false;
+  }
+
+  ret = it->second.get<bool>();
+
+  return true;
+}
+
+bool ParseNumberProperty(double &ret, std::string &err,
+                         const JsonObject &o, const std::string &property,
+                         bool required) {
+  JsonObject::const_iterator it = o.find(property);
+  if (it == o.end()) {
+    if (required) {
+      err += "'" + property + "' property is missing.\n";
+    }
+    return false;
+  }
+
+  if (!it->second.is<double>()) {
+    if (required) {
+      err += "'" + property + "' property is not a number type.\n";
+    }
+    return false;
+  }
+
+  ret = it->second.get<double>();
+
+  return true;
+}
+
+// Converts a byte count, offset or stride parsed as a number. Returns false
+// and appends to `err` unless `value` is a non-negative integer that fits in
+// size_t, since converting anything else is undefined.
+bool NumberToSize(size_t &ret, std::string &err, double value,
+                  const std::string &property) {
+  // SIZE_MAX itself is not representable as a double, but one past it is.
+  const double limit =
+      static_cast<double>((std::numeric_limits<size_t>::max)() / 2 + 1) * 2.0;
+  if (!(value >= 0.0) || !(value < limit) ||
+      (static_cast<double>(static_cast<size_t>(value)) != value)) {
+    err += "'" + property + "' property is not a valid size.\n";
+    return false;
+  }
+
+  ret = static_cast<size_t>(value);
+  return true;
+}
+
+bool ParseNumberArrayProperty(std::vector<double> &ret, std::string &err,
+                              const JsonObject &o,
+                              const std::string &property, bool required) {
+  JsonObject::const_iterator it = o.find(property);
+  if (it == o.end()) {
+    if (required) {
+      err += "'" + property + "' property is missing.\n";
+    }
+    return false;
+  }
+
+  if (!it->second.is<JsonArray>()) {
+    if (required) {
+      err += "'" + property + "' property is not an array.\n";
+    }
+    return false;
+  }
+
+  ret.clear();
+  const JsonArray &arr = it->second.get<JsonArray>();
+  ret.reserve(arr.size());
+  for (size_t i = 0; i < arr.size(); i++) {
+    if (!arr[i].is<double>()) {
+      if (required) {
+        err += "'" + property + "' property is not a number.\n";
+      }
+      return false;
+    }
+    ret.push_back(arr[i].get<double>());
+  }
+
+  return true;
+}
+
+// Returns the string property in place, without copying it. Use this instead
+// of ParseStringProperty for values which may be large (e.g. data URIs) and
+// are only read.
+bool FindStringProperty(JsonString &ret, std::string &err, const JsonObject &o,
+                        const std::string &property, bool required) {
+  JsonObject::const_iterator it = o.find(property);
+  if (it == o.end()) {
+    if (required) {
+      err += "'" + property + "' property is missing.\n";
+    }
+    return false;
+  }
+
+  if (!it->second.is<JsonString>()) {
+    if (required) {
+      err += "'" + property + "' property is not a string type.\n";
+    }
+    return false;
+  }
+
+  ret = it->second.get<JsonString>();
+
+  return true;
+}
+
+bool ParseStringProperty(std::string &ret, std::string &err,
+                         const JsonObject &o, const std::string &property,
+                         bool required) {
+  JsonString value;
+  if (!FindStringProperty(value, err, o, property, required)) {
+    return false;
+  }
+
+  ret.assign(value.data(), value.size());
+
+  return true;
+}
+
+// Resolves a reference to an entry of `section`: an id string in glTF 1.0,
+// an array index in glTF 2.0.
+bool ParseHandle(int &ret, const JsonValue &value, HandleResolver &resolver,
+                 Section section) {
+  if (resolver.indexed()) {
+    return value.is<double>() &&
+           resolver.InternIndex(section, value.get<double>(), ret);
+  }
+
+  if (!value.is<JsonString>()) {
+    return false;
+  }
+  ret = resolver.Intern(section, value.get<JsonString>());
+  return true;
+}
+
+// Unlike the other Parse*Property functions, a missing optional reference or
+// array of references leaves `ret` alone and succeeds, while one that is
+// present but invalid fails even when optional: a dangling reference would be
+// dropped otherwise.
+bool ParseHandleProperty(int &ret, std::string &err, const JsonObject &o,
+                         const std::string &property, bool required,
+                         HandleResolver &resolver, Section section) {
+  JsonObject::const_iterator it = o.find(property);
+  if (it == o.end()) {
+    if (required) {
+      err += "'" + property + "' property is missing.\n";
+    }
+    return !required;
+  }
+
+  if (!ParseHandle(ret, it->second, resolver, section)) {
+    err += "'" + property + "' property is not a valid reference.\n";
+    return false;
+  }
+
+  return true;
+}
+
+bool ParseHandleArrayProperty(std::vector<int> &ret, std::string &err,
+                              const JsonObject &o,
+                              const std::string &property, bool required,
+                              HandleResolver &resolver, Section section) {
+  JsonObject::const_iterator it = o.find(property);
+  if (it == o.end()) {
+    if (required) {
+      err += "'" + property + "' property is missing.\n";
+    }
+    return !required;
+  }
+
+  if (!it->second.is<JsonArray>()) {
+    err += "'" + property + "' property is not an array.\n";
+    return false;
+  }
+
+  ret.clear();
+  const JsonArray &arr = it->second.get<JsonArray>();
+  ret.reserve(arr.size());
+  for (size_t i = 0; i < arr.size(); i++) {
+    int handle;
+    if (!ParseHandle(handle, arr[i], resolver, section)) {
+      err += "'" + property + "' property is not a valid reference.\n";
+      return false;
+    }
+    ret.push_back(handle);
+  }
+
+  return true;
+}
+
+bool ParseAsset(Asset &asset, std::string &err, const JsonObject &o) {
+
+  ParseStringProperty(asset.generator, err, o, "generator", false);
+  ParseBooleanProperty(asset.premultipliedAlpha, err, o, "premultipliedAlpha",
+                       false);
+
+  ParseStringProperty(asset.version, err, o, "version", false);
+
+  JsonObject::const_iterator profile = o.find("profile");
+  if ((profile != o.end()) && (profile->second).is<JsonObject>()) {
+    const JsonObject &v = (profile->second).get<JsonObject>();
+    ParseStringProperty(asset.profile_api, err, v, "api", false);
+    ParseStringProperty(asset.profile_version, err, v, "version", false);
+  }
+
+  return true;
+}
+
+bool ParseImage(Image &image, std::string &err, const JsonObject &o,
+                const std::string &basedir, HandleResolver &resolver) {
+
+  ParseStringProperty(image.name, err, o, "name", false);
+
+  image.bufferView = -1;
+  if (resolver.indexed()) {
+    if (!ParseHandleProperty(image.bufferView, err, o, "bufferView", false,
+                             resolver, SECTION_BUFFER_VIEWS)) {
+      return false;
+    }
+    if (image.bufferView >= 0) {
+      ParseStringProperty(image.mimeType, err, o, "mimeType", false);
+    }
+  }
+
+  // Images embedded in a binary glTF container are stored in a bufferView.
+  JsonObject::const_iterator ext = o.find("extensions");
+  if ((ext != o.end()) && (ext->second).is<JsonObject>()) {
+    const JsonObject &extensions =
+        (ext->second).get<JsonObject>();
+    JsonObject::const_iterator binary =
+        extensions.find("KHR_binary_glTF");
+    if ((binary != extensions.end()) &&
+        (binary->second).is<JsonObject>()) {
+      const JsonObject &binaryObject =
+          (binary->second).get<JsonObject>();
+      if (!ParseHandleProperty(image.bufferView, err, binaryObject,
+                               "bufferView", true, resolver,
+                               SECTION_BUFFER_VIEWS)) {
+        return false;
+      }
+      ParseStringProperty(image.mimeType, err, binaryObject, "mimeType",
+                          false);
+    }
+  }
+
+  if ((image.bufferView < 0) &&
+      !ParseStringProperty(image.uri, err, o, "uri", true)) {
+    return false;
+  }
+
+  image.baseDir = basedir;
+
+  return true;
+}
+
+// Locates the elements of every accessor, checking once that they lie
+// within their bufferView and buffer.
+bool ResolveAccessorViews(Scene &scene, std::string &err) {
+  scene.accessorViews.assign(scene.accessors.size(), AccessorView());
+  for (size_t i = 0; i < scene.accessors.size(); i++) {
+    const int handle = static_cast<int>(i);
+    const Accessor &accessor = scene.accessors[handle];
+    if (accessor.bufferView < 0) {
+      if (accessor.count == 0) {
+        continue;
+      }
+      err += "Accessor \"" + scene.accessors.name(handle) +
+             "\" has no bufferView. Sparse accessors are not supported.\n";
+      return false;
+    }
+    const BufferView &bufferView = scene.bufferViews[accessor.bufferView];
+    const Buffer &buffer = scene.buffers[bufferView.buffer];
+
+    const size_t elementSize = GetTypeComponentCount(accessor.type) *
+                               GetComponentSizeInBytes(accessor.componentType);
+    if (elementSize == 0) {
+      err += "Accessor \"" + scene.accessors.name(handle) +
+             "\" has an unsupported element type.\n";
+      return false;
+    }
+    // glTF 1.0 keeps the stride on the accessor, glTF 2.0 on the bufferView.
+    size_t stride = accessor.byteStride;
+    if (stride == 0) {
+      stride = (bufferView.byteStride != 0) ? bufferView.byteStride
+                                            : elementSize;
+    }
+    if (stride < elementSize) {
+      err += "Accessor \"" + scene.accessors.name(handle) +
+             "\" has a byteStride smaller than its elements.\n";
+      return false;
+    }
+    if (accessor.normalized &&
+        (GetComponentSizeInBytes(accessor.componentType) > 2 ||
+         accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)) {
+      err += "Accessor \"" + scene.accessors.name(handle) +
+             "\" is normalized but its components are not 8 or 16-bit "
+             "integers.\n";
+      return false;
+    }
+
+    // A bufferView without byteLength extends to the end of its buffer.
+    size_t viewLength = 0;
+    if (bufferView.byteOffset <= buffer.size()) {
+      viewLength = buffer.size() - bufferView.byteOffset;
+    }
+    if ((bufferView.byteLength != 0) && (bufferView.byteLength < viewLength)) {
+      viewLength = bufferView.byteLength;
+    }
+
+    // The last element has to end within the view; written to not overflow.
+    if ((accessor.count > 0) &&
+        ((accessor.byteOffset > viewLength) ||
+         (elementSize > viewLength - accessor.byteOffset) ||
+         ((viewLength - accessor.byteOffset - elementSize) / stride <
+          accessor.count - 1))) {
+      err += "Accessor \"" + scene.accessors.name(handle) +
+             "\" is out of range of its bufferView.\n";
+      return false;
+    }
+
+    AccessorView &view = scene.accessorViews[i];
+    if (accessor.count > 0) {
+      view.data = buffer.bytes() + bufferView.byteOffset + accessor.byteOffset;
+    }
+    view.byteStride = stride;
+    view.count = accessor.count;
+    view.componentType = accessor.componentType;
+    view.type = accessor.type;
+    view.normalized = accessor.normalized;
+  }
+
+  return true;
+}
+
+bool DecodeImageData(Image &image, std::string &err, const Scene &scene,
+                     bool allowMapping, ResourceCache *cache,
+                     ResourcePrefetcher *prefetcher) {
+  std::vector<unsigned char> img;
+  std::shared_ptr<MappedFile> file;
+  const unsigned char *encoded = NULL;
+  size_t encodedLength = 0;
+  if (image.bufferView >= 0) {
+    if (static_cast<size_t>(image.bufferView) >= scene.bufferViews.size()) {
+      err += "Image refers to unknown bufferView.\n";
+      return false;
+    }
+    const BufferView &view = scene.bufferViews[image.bufferView];
+    // The view has to lie within its buffer; written to not overflow.
+    if ((view.buffer < 0) ||
+        (static_cast<size_t>(view.buffer) >= scene.buffers.size()) ||
+        (view.byteOffset > scene.buffers[view.buffer].size()) ||
+        (view.byteLength >
+         scene.buffers[view.buffer].size() - view.byteOffset) ||
+        (view.byteLength == 0)) {
+      err += "Invalid bufferView \"" +
+             scene.bufferViews.name(image.bufferView) + "\" for image.\n";
+      return false;
+    }
+    encoded = scene.buffers[view.buffer].bytes() + view.byteOffset;
+    encodedLength = view.byteLength;
+  } else if (size_t header = DataURIHeaderLength(image.uri)) {
+    if (!DecodeDataURI(img, image.uri.data() + header,
+                       image.uri.size() - header, 0, false)) {
+      err += "Failed to decode 'uri'.\n";
+      return false;
+    }
+    encoded = &img.at(0);
+    encodedLength = img.size();
+  } else {
+    // Assume external file
+    if (!LoadExternalFile(file, err, image.uri, image.baseDir, 0, false,
+                          allowMapping, cache, prefetcher)) {
+      err += "Failed to load external 'uri'.\n";
+      return false;
+    }
+    if (file->size() == 0) {
+      err += "File is empty.\n";
+      return false;
+    }
+    encoded = file->data();
+    encodedLength = file->size();
+  }
+
+  int w, h, comp;
+  unsigned char *data = stbi_load_from_memory(
+      encoded, static_cast<int>(encodedLength), &w, &h, &comp, 0);
+  if (!data) {
+    err += "Unknown image format.\n";
+    return false;
+  }
+
+  if (w < 1 || h < 1) {
+    stbi_image_free(data);
+    err += "Unknown image format.\n";
+    return false;
+  }
+
+  image.width = w;
+  image.height = h;
+  image.component = comp;
+  image.image.assign(data, data + w * h * comp);
+  stbi_image_free(data);
+
+  return true;
+}
+
+bool ParseTexture(Texture &texture, std::string &err, const JsonObject &o,
+                  const std::string &basedir, HandleResolver &resolver) {
+
+  // glTF 2.0 leaves out both when the texture is provided by an extension.
+  const bool required = !resolver.indexed();
+  if (required) {
+    if (!ParseStringProperty(texture.sampler, err, o, "sampler", true)) {
+      return false;
+    }
+  } else {
+    double sampler;
+    if (ParseNumberProperty(sampler, err, o, "sampler", false)) {
+      texture.sampler = std::to_string(static_cast<long long>(sampler));
+    }
+  }
+
+  texture.source = -1;
+  if (!ParseHandleProperty(texture.source, err, o, "source", required,
+                           resolver, SECTION_IMAGES)) {
+    return false;
+  }
+
+  ParseStringProperty(texture.name, err, o, "name", false);
+
+  double format = TINYGLTF_TEXTURE_FORMAT_RGBA;
+  ParseNumberProperty(format, err, o, "format", false);
+
+  double internalFormat = TINYGLTF_TEXTURE_FORMAT_RGBA;
+  ParseNumberProperty(internalFormat, err, o, "internalFormat", false);
 
-    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-    char_array_4[3] = char_array_3[2] & 0x3f;
+  double target = TINYGLTF_TEXTURE_TARGET_TEXTURE2D;
+  ParseNumberProperty(target, err, o, "target", false);
 
-    for (j = 0; (j < i + 1); j++)
-      ret += base64_chars[char_array_4[j]];
+  double type = TINYGLTF_TEXTURE_TYPE_UNSIGNED_BYTE;
+  ParseNumberProperty(type, err, o, "type", false);
 
-    while((i++ < 3))
-      ret += '=';
+  texture.format = static_cast<int>(format);
+  texture.internalFormat = static_cast<int>(internalFormat);
+  texture.target = static_cast<int>(target);
+  texture.type = static_cast<int>(type);
+
+  return true;
+}
 
+// Parses a buffer. Embedded data is decoded right away. For an external file
+// `externalUri` is set instead and the file is attached later with
+// LoadBufferFile, so reading it can overlap with parsing the rest of the
+// document. Without `readData` only the buffer's description is parsed.
+bool ParseBuffer(Buffer &buffer, std::string &err, const JsonObject &o,
+                 const unsigned char *binaryBody, size_t binaryBodyLength,
+                 const std::shared_ptr<const void> &binaryOwner,
+                 bool readData, std::string &externalUri,
+                 size_t &byteLength) {
+  externalUri.clear();
+
+  double length;
+  if (!ParseNumberProperty(length, err, o, "byteLength", true)) {
+    return false;
   }
 
-  return ret;
+  // The "binary_glTF" buffer of a binary container has no meaningful uri.
+  JsonString uri;
+  if (!binaryBody && !FindStringProperty(uri, err, o, "uri", true)) {
+    return false;
+  }
+
+  JsonObject::const_iterator type = o.find("type");
+  if (type != o.end()) {
+    if (type->second.is<JsonString>()) {
+      const JsonString &ty = (type->second).get<JsonString>();
+      if (ty.compare("arraybuffer") == 0) {
+        // buffer.type = "arraybuffer";
+      }
+    }
+  }
+
+  size_t bytes = 0;
+  if (!NumberToSize(bytes, err, length, "byteLength")) {
+    return false;
+  }
+  byteLength = bytes;
+  if (binaryBody) {
+    // Reference the container's body in place.
+    if (bytes > binaryBodyLength) {
+      std::stringstream ss;
+      ss << "Binary glTF body is too small : byteLength " << bytes
+         << ", but got " << binaryBodyLength << std::endl;
+      err += ss.str();
+      return false;
+    }
+    buffer.view = binaryBody;
+    buffer.viewLength = bytes;
+    buffer.owner = binaryOwner;
+  } else if (!readData) {
+    // Leave the data alone.
+  } else if (size_t header = DataURIHeaderLength(uri.data(), uri.size())) {
+    if (!DecodeDataURI(buffer.data, uri.data() + header, uri.size() - header,
+                       bytes, true)) {
+      err += "Failed to decode 'uri'.\n";
+      return false;
+    }
+  } else {
+    // Assume external .bin file.
+    externalUri = uri.str();
+  }
+
+  ParseStringProperty(buffer.name, err, o, "name", false);
 
+  return true;
 }
-#endif
 
-std::string base64_decode(std::string const &encoded_string) {
-  int in_len = encoded_string.size();
-  int i = 0;
-  int j = 0;
-  int in_ = 0;
-  unsigned char char_array_4[4], char_array_3[3];
-  std::string ret;
+// Attaches the external file `uri` to `buffer`. The buffer references the file
+// contents directly instead of copying them.
+bool LoadBufferFile(Buffer &buffer, std::string &err, const std::string &uri,
+                    size_t byteLength, const std::string &basedir,
+                    bool allowMapping, ResourceCache *cache,
+                    ResourcePrefetcher *prefetcher) {
+  std::shared_ptr<MappedFile> file;
+  if (!LoadExternalFile(file, err, uri, basedir, byteLength, true,
+                        allowMapping, cache, prefetcher)) {
+    return false;
+  }
+  buffer.view = file->data();
+  buffer.viewLength = file->size();
+  buffer.owner = file;
 
-  while (in_len-- && (encoded_string[in_] != '=') &&
-         is_base64(encoded_string[in_])) {
-    char_array_4[i++] = encoded_string[in_];
-    in_++;
-    if (i == 4) {
-      for (i = 0; i < 4; i++)
-        char_array_4[i] = base64_chars.find(char_array_4[i]);
-
-      char_array_3[0] =
-          (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] =
-          ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-      for (i = 0; (i < 3); i++)
-        ret += char_array_3[i];
-      i = 0;
-    }
+  return true;
+}
+
+bool ParseBufferView(BufferView &bufferView, std::string &err,
+                     const JsonObject &o, HandleResolver &resolver) {
+  if (!ParseHandleProperty(bufferView.buffer, err, o, "buffer", true, resolver,
+                           SECTION_BUFFERS)) {
+    return false;
+  }
+
+  // Both offsets are optional in glTF 2.0, which requires the length instead.
+  const bool indexed = resolver.indexed();
+  double byteOffset = 0.0;
+  if (!ParseNumberProperty(byteOffset, err, o, "byteOffset", !indexed) &&
+      !indexed) {
+    return false;
+  }
+
+  double byteLength = 0.0;
+  if (!ParseNumberProperty(byteLength, err, o, "byteLength", indexed) &&
+      indexed) {
+    return false;
   }
 
-  if (i) {
-    for (j = i; j < 4; j++)
-      char_array_4[j] = 0;
+  double byteStride = 0.0;
+  ParseNumberProperty(byteStride, err, o, "byteStride", false);
 
-    for (j = 0; j < 4; j++)
-      char_array_4[j] = base64_chars.find(char_array_4[j]);
+  double target = 0.0;
+  ParseNumberProperty(target, err, o, "target", false);
+  int targetValue = static_cast<int>(target);
+  if ((targetValue == TINYGLTF_TARGET_ARRAY_BUFFER) ||
+      (targetValue == TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER)) {
+    // OK
+  } else {
+    targetValue = 0;
+  }
+  bufferView.target = targetValue;
 
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] =
-        ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-    char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+  ParseStringProperty(bufferView.name, err, o, "name", false);
 
-    for (j = 0; (j < i - 1); j++)
-      ret += char_array_3[j];
+  if (!NumberToSize(bufferView.byteOffset, err, byteOffset, "byteOffset") ||
+      !NumberToSize(bufferView.byteLength, err, byteLength, "byteLength") ||
+      !NumberToSize(bufferView.byteStride, err, byteStride, "byteStride")) {
+    return false;
   }
 
-  return ret;
+  return true;
 }
 
-bool LoadExternalFile(std::vector<unsigned char> &out, std::string &err,
-                      const std::string &filename, const std::string &basedir,
-                      size_t reqBytes, bool checkSize) {
-  out.clear();
+bool ParseAccessor(Accessor &accessor, std::string &err,
+                   const JsonObject &o, HandleResolver &resolver) {
+  // A glTF 2.0 accessor without bufferView is sparse or all zeros.
+  const bool required = !resolver.indexed();
+  accessor.bufferView = -1;
+  if (!ParseHandleProperty(accessor.bufferView, err, o, "bufferView",
+                           required, resolver, SECTION_BUFFER_VIEWS)) {
+    return false;
+  }
 
-  std::vector<std::string> paths;
-  paths.push_back(basedir);
-  paths.push_back(".");
+  double byteOffset = 0.0;
+  if (!ParseNumberProperty(byteOffset, err, o, "byteOffset", required) &&
+      required) {
+    return false;
+  }
 
-  std::string filepath = FindFile(paths, filename);
-  if (filepath.empty()) {
-    err += "File not found : " + filename;
+  accessor.normalized = false;
+  ParseBooleanProperty(accessor.normalized, err, o, "normalized", false);
+
+  double componentType;
+  if (!ParseNumberProperty(componentType, err, o, "componentType", true)) {
     return false;
   }
 
-  std::ifstream f(filepath.c_str(), std::ifstream::binary);
-  if (!f) {
-    err += "File open error : " + filepath;
+  double count = 0.0;
+  if (!ParseNumberProperty(count, err, o, "count", true)) {
     return false;
   }
 
-  f.seekg(0, f.end);
-  size_t sz = f.tellg();
-  std::vector<unsigned char> buf(sz);
+  JsonString type;
+  if (!FindStringProperty(type, err, o, "type", true)) {
+    return false;
+  }
 
-  f.seekg(0, f.beg);
-  f.read(reinterpret_cast<char *>(&buf.at(0)), sz);
-  f.close();
+  if (type.compare("SCALAR") == 0) {
+    accessor.type = TINYGLTF_TYPE_SCALAR;
+  } else if (type.compare("VEC2") == 0) {
+    accessor.type = TINYGLTF_TYPE_VEC2;
+  } else if (type.compare("VEC3") == 0) {
+    accessor.type = TINYGLTF_TYPE_VEC3;
+  } else if (type.compare("VEC4") == 0) {
+    accessor.type = TINYGLTF_TYPE_VEC4;
+  } else if (type.compare("MAT2") == 0) {
+    accessor.type = TINYGLTF_TYPE_MAT2;
+  } else if (type.compare("MAT3") == 0) {
+    accessor.type = TINYGLTF_TYPE_MAT3;
+  } else if (type.compare("MAT4") == 0) {
+    accessor.type = TINYGLTF_TYPE_MAT4;
+  } else {
+    std::stringstream ss;
+    ss << "Unsupported `type` for accessor object. Got \"" << type.str()
+       << "\"\n";
+    err += ss.str();
+    return false;
+  }
 
-  if (checkSize) {
-    if (reqBytes == sz) {
-      out.swap(buf);
-      return true;
+  double byteStride = 0.0;
+  ParseNumberProperty(byteStride, err, o, "byteStride", false);
+
+  ParseStringProperty(accessor.name, err, o, "name", false);
+
+  accessor.minValues.clear();
+  accessor.maxValues.clear();
+  ParseNumberArrayProperty(accessor.minValues, err, o, "min", false);
+  ParseNumberArrayProperty(accessor.maxValues, err, o, "max", false);
+
+  if (!NumberToSize(accessor.count, err, count, "count") ||
+      !NumberToSize(accessor.byteOffset, err, byteOffset, "byteOffset") ||
+      !NumberToSize(accessor.byteStride, err, byteStride, "byteStride")) {
+    return false;
+  }
+
+  {
+    int comp = static_cast<size_t>(componentType);
+    if (comp >= TINYGLTF_COMPONENT_TYPE_BYTE &&
+        comp <= TINYGLTF_COMPONENT_TYPE_DOUBLE) {
+      // OK
+      accessor.componentType = comp;
     } else {
       std::stringstream ss;
-      ss << "File size mismatch : " << filepath << ", requestedBytes "
-         << reqBytes << ", but got " << sz << std::endl;
+      ss << "Invalid `componentType` in accessor. Got " << comp << "\n";
       err += ss.str();
       return false;
     }
   }
 
-  out.swap(buf);
   return true;
 }
 
-bool IsDataURI(const std::string &in) {
-  std::string header = "data:application/octet-stream;base64,";
-  if (in.find(header) == 0) {
-    return true;
+bool ParsePrimitive(Primitive &primitive, std::string &err,
+                    const JsonObject &o, HandleResolver &resolver) {
+  const bool required = !resolver.indexed();
+  primitive.material = -1;
+  if (!ParseHandleProperty(primitive.material, err, o, "material", required,
+                           resolver, SECTION_MATERIALS)) {
+    return false;
   }
 
-  header = "data:image/png;base64,";
-  if (in.find(header) == 0) {
-    return true;
-  }
+  double mode = static_cast<double>(TINYGLTF_MODE_TRIANGLES);
+  ParseNumberProperty(mode, err, o, "mode", false);
 
-  header = "data:image/jpeg;base64,";
-  if (in.find(header) == 0) {
-    return true;
+  int primMode = static_cast<int>(mode);
+  if ((primMode != TINYGLTF_MODE_TRIANGLES) &&
+      (primMode != TINYGLTF_MODE_TRIANGLE_STRIP) &&
+      (primMode != TINYGLTF_MODE_TRIANGLE_FAN)) {
+    err += "Currently TinyGLTFLoader doesn not support primitive mode other \n"
+           "than TRIANGLES, TRIANGLE_STRIP and TRIANGLE_FAN.\n";
+    return false;
   }
+  primitive.mode = primMode;
 
-  return false;
-}
-
-bool DecodeDataURI(std::vector<unsigned char> &out, const std::string &in,
-                   size_t reqBytes, bool checkSize) {
-  std::string header = "data:application/octet-stream;base64,";
-  std::string data;
-  if (in.find(header) == 0) {
-    data = base64_decode(in.substr(header.size())); // cut mime string.
+  primitive.indices = -1;
+  if (!ParseHandleProperty(primitive.indices, err, o, "indices", false,
+                           resolver, SECTION_ACCESSORS)) {
+    return false;
   }
 
-  if (data.empty()) {
-    header = "data:image/jpeg;base64,";
-    if (in.find(header) == 0) {
-      data = base64_decode(in.substr(header.size())); // cut mime string.
+  primitive.attributes.clear();
+  JsonObject::const_iterator attribsObject = o.find("attributes");
+  if ((attribsObject != o.end()) &&
+      (attribsObject->second).is<JsonObject>()) {
+    const JsonObject &attribs =
+        (attribsObject->second).get<JsonObject>();
+    JsonObject::const_iterator it(attribs.begin());
+    JsonObject::const_iterator itEnd(attribs.end());
+    for (; it != itEnd; it++) {
+      int accessor;
+      if (!ParseHandle(accessor, it->second, resolver, SECTION_ACCESSORS)) {
+        err += "attribute expects a reference to an accessor.\n";
+        return false;
+      }
+
+      primitive.attributes[it->first.str()] = accessor;
     }
   }
 
-  if (data.empty()) {
-    header = "data:image/png;base64,";
-    if (in.find(header) == 0) {
-      data = base64_decode(in.substr(header.size())); // cut mime string.
+  return true;
+}
+
+bool ParseMesh(Mesh &mesh, std::string &err, const JsonObject &o,
+               HandleResolver &resolver) {
+  ParseStringProperty(mesh.name, err, o, "name", false);
+
+  mesh.primitives.clear();
+  JsonObject::const_iterator primObject = o.find("primitives");
+  if ((primObject != o.end()) && (primObject->second).is<JsonArray>()) {
+    const JsonArray &primArray =
+        (primObject->second).get<JsonArray>();
+    mesh.primitives.resize(primArray.size());
+    for (size_t i = 0; i < primArray.size(); i++) {
+      if (!primArray[i].is<JsonObject>()) {
+        err += "primitive expects object value.\n";
+        return false;
+      }
+      if (!ParsePrimitive(mesh.primitives[i], err,
+                          primArray[i].get<JsonObject>(), resolver)) {
+        return false;
+      }
     }
   }
 
-  if (data.empty()) {
+  return true;
+}
+
+bool ParseNode(Node &node, std::string &err, const JsonObject &o,
+               HandleResolver &resolver) {
+  ParseStringProperty(node.name, err, o, "name", false);
+
+  ParseNumberArrayProperty(node.rotation, err, o, "rotation", false);
+  ParseNumberArrayProperty(node.scale, err, o, "scale", false);
+  ParseNumberArrayProperty(node.translation, err, o, "translation", false);
+  ParseNumberArrayProperty(node.matrix, err, o, "matrix", false);
+  node.meshes.clear();
+  if (resolver.indexed()) {
+    int mesh = -1;
+    if (!ParseHandleProperty(mesh, err, o, "mesh", false, resolver,
+                             SECTION_MESHES)) {
+      return false;
+    }
+    if (mesh >= 0) {
+      node.meshes.push_back(mesh);
+    }
+  } else if (!ParseHandleArrayProperty(node.meshes, err, o, "meshes", false,
+                                       resolver, SECTION_MESHES)) {
     return false;
   }
 
-  if (checkSize) {
-    if (data.size() != reqBytes) {
-      return false;
+  node.children.clear();
+  JsonObject::const_iterator childrenObject = o.find("children");
+  if ((childrenObject != o.end()) &&
+      (childrenObject->second).is<JsonArray>()) {
+    const JsonArray &childrenArray =
+        (childrenObject->second).get<JsonArray>();
+    for (size_t i = 0; i < childrenArray.size(); i++) {
+      int child;
+      if (!ParseHandle(child, childrenArray[i], resolver, SECTION_NODES)) {
+        err += "Invalid `children` array.\n";
+        return false;
+      }
+      node.children.push_back(child);
     }
-    out.resize(reqBytes);
-  } else {
-    out.resize(data.size());
   }
-  std::copy(data.begin(), data.end(), out.begin());
-  return true;
 
-  return false;
+  return true;
 }
 
-bool ParseBooleanProperty(bool &ret, std::string &err,
-                          const picojson::object &o,
-                          const std::string &property, bool required) {
-  picojson::object::const_iterator it = o.find(property);
-  if (it == o.end()) {
-    if (required) {
-      err += "'" + property + "' property is missing.\n";
+// Stores a glTF 2.0 material property in `values` the way glTF 1.0 stores
+// technique parameters. A textureInfo object becomes its texture index.
+void ParseMaterialValue(Material &material, const std::string &name,
+                        const JsonValue &value) {
+  Parameter &param = material.values[name];
+  param = Parameter();
+  if (value.is<JsonString>()) {
+    param.stringValue = value.get<JsonString>().str();
+  } else if (value.is<bool>()) {
+    param.numberArray.push_back(value.get<bool>() ? 1.0 : 0.0);
+  } else if (value.is<double>()) {
+    param.numberArray.push_back(value.get<double>());
+  } else if (value.is<JsonArray>()) {
+    const JsonArray &arr = value.get<JsonArray>();
+    param.numberArray.reserve(arr.size());
+    for (size_t i = 0; (i < arr.size()) && arr[i].is<double>(); i++) {
+      param.numberArray.push_back(arr[i].get<double>());
+    }
+  } else if (value.is<JsonObject>()) {
+    const JsonObject &info = value.get<JsonObject>();
+    JsonObject::const_iterator index = info.find("index");
+    if ((index != info.end()) && (index->second).is<double>()) {
+      param.stringValue = std::to_string(
+          static_cast<long long>((index->second).get<double>()));
     }
-    return false;
   }
+}
 
-  if (!it->second.is<bool>()) {
-    if (required) {
-      err += "'" + property + "' property is not a bool type.\n";
+// Flattens a glTF 2.0 material, including its pbrMetallicRoughness block,
+// into `values`.
+bool ParseMaterial2(Material &material, std::string &err,
+                    const JsonObject &o) {
+  ParseStringProperty(material.name, err, o, "name", false);
+  material.technique.clear();
+  material.values.clear();
+
+  JsonObject::const_iterator it(o.begin());
+  JsonObject::const_iterator itEnd(o.end());
+  for (; it != itEnd; it++) {
+    const std::string key = it->first.str();
+    if ((key.compare("name") == 0) || (key.compare("extensions") == 0) ||
+        (key.compare("extras") == 0)) {
+      continue;
     }
-    return false;
-  }
 
-  ret = it->second.get<bool>();
+    if ((key.compare("pbrMetallicRoughness") == 0) &&
+        (it->second).is<JsonObject>()) {
+      const JsonObject &pbr = (it->second).get<JsonObject>();
+      for (JsonObject::const_iterator pit = pbr.begin(); pit != pbr.end();
+           pit++) {
+        ParseMaterialValue(material, pit->first.str(), pit->second);
+      }
+      continue;
+    }
+
+    ParseMaterialValue(material, key, it->second);
+  }
 
   return true;
 }
 
-bool ParseNumberProperty(double &ret, std::string &err,
-                         const picojson::object &o, const std::string &property,
-                         bool required) {
-  picojson::object::const_iterator it = o.find(property);
-  if (it == o.end()) {
-    if (required) {
-      err += "'" + property + "' property is missing.\n";
+bool ParseMaterial(Material &material, std::string &err,
+                   const JsonObject &o) {
+  ParseStringProperty(material.name, err, o, "name", false);
+  ParseStringProperty(material.technique, err, o, "technique", false);
+
+  material.values.clear();
+  JsonObject::const_iterator valuesIt = o.find("values");
+  if ((valuesIt != o.end()) && (valuesIt->second).is<JsonObject>()) {
+
+    const JsonObject &valuesObject =
+        (valuesIt->second).get<JsonObject>();
+    JsonObject::const_iterator it(valuesObject.begin());
+    JsonObject::const_iterator itEnd(valuesObject.end());
+
+    for (; it != itEnd; it++) {
+      // Assume number values. A repeated key replaces the earlier value.
+      Parameter &param = material.values[it->first.str()];
+      param = Parameter();
+      const JsonValue &value = it->second;
+      if (value.is<JsonString>()) {
+        // Found string property.
+        param.stringValue = value.get<JsonString>().str();
+      } else if (value.is<JsonArray>()) {
+        const JsonArray &arr = value.get<JsonArray>();
+        param.numberArray.reserve(arr.size());
+        for (size_t i = 0; (i < arr.size()) && arr[i].is<double>(); i++) {
+          param.numberArray.push_back(arr[i].get<double>());
+        }
+      } else if (value.is<double>()) {
+        // Fallback to numer property.
+        param.numberArray.push_back(value.get<double>());
+      }
     }
-    return false;
   }
 
-  if (!it->second.is<double>()) {
-    if (required) {
-      err += "'" + property + "' property is not a number type.\n";
+  return true;
+}
+}
+
+namespace tinygltf {
+
+/// A run of consecutive entries of one top-level section, located in the
+/// document before any entry is parsed so that runs can be parsed
+/// independently of each other.
+struct SectionChunk {
+  Section section;
+  const char *first; // After the section's opening bracket or a ','.
+  const char *last;  // At the ',' or bracket ending the run.
+  int line;          // Line of `first`.
+  size_t index;      // Number of entries in the section before `first`.
+};
+
+// Sections are split into chunks of about this many bytes.
+static const size_t kSectionChunkSize = 256 * 1024;
+
+// Finds the end of the object or array whose opening bracket is just before
+// `first`, checking only the nesting of brackets outside of strings; the
+// entries themselves are validated when their chunks are parsed. Chunks are
+// appended to `chunks`, split at top-level ','. `line` is advanced past the
+// section. Returns the position after the closing bracket, or NULL if the
+// section is not closed.
+const char *SplitSection(std::vector<SectionChunk> &chunks, Section section,
+                         const char *first, const char *last, char close,
+                         int &line) {
+  SectionChunk chunk;
+  chunk.section = section;
+  chunk.first = first;
+  chunk.line = line;
+  chunk.index = 0;
+
+  size_t entries = 0;
+  int depth = 0;
+  for (const char *p = first; p != last; ++p) {
+    switch (*p) {
+    case '\n':
+      line++;
+      break;
+    case '"':
+      for (++p;; ++p) {
+        p = picojson::_find_string_special(p, last);
+        if (p == last) {
+          return NULL;
+        } else if (*p == '"') {
+          break;
+        } else if (*p == '\n') {
+          line++;
+        } else if ((*p == '\\') && (++p == last)) {
+          return NULL;
+        }
+      }
+      break;
+    case '{':
+    case '[':
+      depth++;
+      break;
+    case '}':
+    case ']':
+      if (depth-- > 0) {
+        break;
+      }
+      if (*p != close) {
+        return NULL;
+      }
+      chunk.last = p;
+      chunks.push_back(chunk);
+      return p + 1;
+    case ',':
+      if (depth > 0) {
+        break;
+      }
+      entries++;
+      if (static_cast<size_t>(p - chunk.first) >= kSectionChunkSize) {
+        chunk.last = p;
+        chunks.push_back(chunk);
+        chunk.first = p + 1;
+        chunk.line = line;
+        chunk.index = entries;
+      }
+      break;
+    default:
+      break;
     }
-    return false;
   }
 
-  ret = it->second.get<double>();
-
-  return true;
+  return NULL;
 }
 
-bool ParseNumberArrayProperty(std::vector<double> &ret, std::string &err,
-                              const picojson::object &o,
-                              const std::string &property, bool required) {
-  picojson::object::const_iterator it = o.find(property);
-  if (it == o.end()) {
-    if (required) {
-      err += "'" + property + "' property is missing.\n";
-    }
-    return false;
-  }
+/// Maps the handles of one scene to those of another scene holding the same
+/// ids, per section.
+struct HandleRemap {
+  std::vector<int> handles[SECTION_COUNT];
+  bool indexed; // glTF 2.0: references are indices and stay as they are.
 
-  if (!it->second.is<picojson::array>()) {
-    if (required) {
-      err += "'" + property + "' property is not an array.\n";
+  void Apply(Section section, int &handle) const {
+    if (!indexed && (handle >= 0)) {
+      handle = handles[section][handle];
     }
-    return false;
   }
-
-  ret.clear();
-  const picojson::array &arr = it->second.get<picojson::array>();
-  for (size_t i = 0; i < arr.size(); i++) {
-    if (!arr[i].is<double>()) {
-      if (required) {
-        err += "'" + property + "' property is not a number.\n";
-      }
-      return false;
+  void Apply(Section section, std::vector<int> &handles) const {
+    for (size_t i = 0; i < handles.size(); i++) {
+      Apply(section, handles[i]);
     }
-    ret.push_back(arr[i].get<double>());
   }
+};
 
-  return true;
+// Rewrites the references held by an entry.
+void RemapHandles(Buffer &, const HandleRemap &) {}
+void RemapHandles(BufferView &bufferView, const HandleRemap &remap) {
+  remap.Apply(SECTION_BUFFERS, bufferView.buffer);
 }
-
-bool ParseStringProperty(std::string &ret, std::string &err,
-                         const picojson::object &o, const std::string &property,
-                         bool required) {
-  picojson::object::const_iterator it = o.find(property);
-  if (it == o.end()) {
-    if (required) {
-      err += "'" + property + "' property is missing.\n";
+void RemapHandles(Accessor &accessor, const HandleRemap &remap) {
+  remap.Apply(SECTION_BUFFER_VIEWS, accessor.bufferView);
+}
+void RemapHandles(Mesh &mesh, const HandleRemap &remap) {
+  for (size_t i = 0; i < mesh.primitives.size(); i++) {
+    Primitive &primitive = mesh.primitives[i];
+    std::map<std::string, int>::iterator it = primitive.attributes.begin();
+    for (; it != primitive.attributes.end(); it++) {
+      remap.Apply(SECTION_ACCESSORS, it->second);
     }
-    return false;
+    remap.Apply(SECTION_MATERIALS, primitive.material);
+    remap.Apply(SECTION_ACCESSORS, primitive.indices);
   }
+}
+void RemapHandles(Node &node, const HandleRemap &remap) {
+  remap.Apply(SECTION_NODES, node.children);
+  remap.Apply(SECTION_MESHES, node.meshes);
+}
+void RemapHandles(std::vector<int> &sceneNodes, const HandleRemap &remap) {
+  remap.Apply(SECTION_NODES, sceneNodes);
+}
+void RemapHandles(Material &, const HandleRemap &) {}
+void RemapHandles(Image &image, const HandleRemap &remap) {
+  remap.Apply(SECTION_BUFFER_VIEWS, image.bufferView);
+}
+void RemapHandles(Texture &texture, const HandleRemap &remap) {
+  remap.Apply(SECTION_IMAGES, texture.source);
+}
 
-  if (!it->second.is<std::string>()) {
-    if (required) {
-      err += "'" + property + "' property is not a string type.\n";
+/// Converts the entries of section chunks into a scene. Each entry is read
+/// into a small JsonValue tree, converted by the Parse* functions and dropped
+/// again, so the document as a whole is never held as a DOM. References
+/// between entries are resolved to handles of the scene while parsing.
+/// External buffers are requested from the prefetcher as soon as they are
+/// seen.
+class EntryParser {
+public:
+  EntryParser(const TinyGLTFLoader &loader, Scene &scene,
+              HandleResolver &resolver, const std::string &baseDir,
+              ResourcePrefetcher &prefetcher)
+      : bufferBytes_(0), failed_(false), loader_(loader), scene_(scene),
+        resolver_(resolver), baseDir_(baseDir), prefetcher_(prefetcher),
+        json_(arena_) {}
+
+  /// Parses the entries of `chunk`.
+  /// Returns false and set error string to `err_` if there's an error.
+  bool Parse(const SectionChunk &chunk);
+
+  /// Parses the entries of a section from `in`, whose opening bracket has
+  /// just been read, up to its closing bracket `close`. Returns false if
+  /// there's an error: a syntax error is left for the caller to describe,
+  /// otherwise `failed_` is set and the error is in `err_`.
+  bool ParseSection(picojson::input<const char *> &in, Section section,
+                    int close);
+
+  struct PendingBuffer {
+    int buffer;
+    std::string uri;
+    size_t byteLength;
+  };
+
+  // Results besides the entries, collected by SceneParser.
+  std::vector<char> defined_[SECTION_COUNT]; // Indexed by handle.
+  std::vector<PendingBuffer> pendingBuffers_;
+  size_t bufferBytes_; // Sum of the buffers' byteLength.
+  std::string err_;
+  bool failed_; // Parsing stopped because of an error in `err_`.
+
+private:
+  EntryParser(const EntryParser &);
+  EntryParser &operator=(const EntryParser &);
+
+  // Parses entries up to `close`, or the end of `in` if `close` is -1.
+  // `index` is the number of entries before the first one.
+  bool ParseEntries(picojson::input<const char *> &in, Section section,
+                    size_t index, int close);
+  bool ParseEntry(picojson::input<const char *> &in, Section section,
+                  const std::string &key);
+  bool ParseSceneEntry(Section section, const std::string &key,
+                       const JsonObject &o);
+
+  const TinyGLTFLoader &loader_;
+  Scene &scene_;
+  HandleResolver &resolver_;
+  const std::string &baseDir_;
+  ResourcePrefetcher &prefetcher_;
+
+  // Holds the entry being converted. Reset for every entry, so its blocks are
+  // reused throughout the chunk.
+  JsonArena arena_;
+  JsonBuilder json_;
+};
+
+bool EntryParser::Parse(const SectionChunk &chunk) {
+  picojson::input<const char *> in(chunk.first, chunk.last, chunk.line);
+  if (!ParseEntries(in, chunk.section, chunk.index, -1)) {
+    if (!failed_) {
+      err_ = picojson::_syntax_error(in);
     }
     return false;
   }
 
-  ret = it->second.get<std::string>();
-
   return true;
 }
 
-bool ParseStringArrayProperty(std::vector<std::string> &ret, std::string &err,
-                              const picojson::object &o,
-                              const std::string &property, bool required) {
-  picojson::object::const_iterator it = o.find(property);
-  if (it == o.end()) {
-    if (required) {
-      err += "'" + property + "' property is missing.\n";
-    }
-    return false;
-  }
+bool EntryParser::ParseSection(picojson::input<const char *> &in,
+                               Section section, int close) {
+  return ParseEntries(in, section, 0, close);
+}
 
-  if (!it->second.is<picojson::array>()) {
-    if (required) {
-      err += "'" + property + "' property is not an array.\n";
-    }
-    return false;
+bool EntryParser::ParseEntries(picojson::input<const char *> &in,
+                               Section section, size_t index, int close) {
+  // Only a whole section can be empty; later chunks start after a ','.
+  if ((index == 0) && in.expect(close)) {
+    return true;
   }
 
-  ret.clear();
-  const picojson::array &arr = it->second.get<picojson::array>();
-  for (size_t i = 0; i < arr.size(); i++) {
-    if (!arr[i].is<std::string>()) {
-      if (required) {
-        err += "'" + property + "' property is not a string.\n";
+  // Sections are checked to match the version before they are parsed, so
+  // glTF 2.0 sections are arrays and glTF 1.0 sections objects.
+  const bool indexed = resolver_.indexed();
+  picojson::object_key<const char *> key;
+  do {
+    if (indexed) {
+      if (!ParseEntry(in, section, std::to_string(index))) {
+        return false;
       }
+    } else if (!in.expect('"') || !key.parse(in) || !in.expect(':') ||
+               !ParseEntry(in, section, key)) {
       return false;
     }
-    ret.push_back(arr[i].get<std::string>());
-  }
+    index++;
+  } while (in.expect(','));
 
-  return true;
+  return in.expect(close);
 }
 
-bool ParseAsset(Asset &asset, std::string &err, const picojson::object &o) {
-
-  ParseStringProperty(asset.generator, err, o, "generator", false);
-  ParseBooleanProperty(asset.premultipliedAlpha, err, o, "premultipliedAlpha",
-                       false);
+bool EntryParser::ParseEntry(picojson::input<const char *> &in,
+                             Section section, const std::string &key) {
+  arena_.Reset();
+  JsonValue entry;
+  if (!json_.Parse(entry, in)) {
+    return false;
+  }
 
-  ParseStringProperty(asset.version, err, o, "version", false);
+  if (!entry.is<JsonObject>()) {
+    err_ += "'" + key + "' in '" + kSectionNames[section] +
+            "' is not an object.\n";
+    failed_ = true;
+    return false;
+  }
 
-  picojson::object::const_iterator profile = o.find("profile");
-  if (profile != o.end()) {
-    const picojson::value &v = profile->second;
-    if (v.contains("api") & v.get("api").is<std::string>()) {
-      asset.profile_api = v.get("api").get<std::string>();
-    }
-    if (v.contains("version") & v.get("version").is<std::string>()) {
-      asset.profile_version = v.get("version").get<std::string>();
-    }
+  if (!ParseSceneEntry(section, key, entry.get<JsonObject>())) {
+    failed_ = true;
+    return false;
   }
 
   return true;
 }
 
-bool ParseImage(Image &image, std::string &err, const picojson::object &o,
-                const std::string &basedir) {
-
-  std::string uri;
-  if (!ParseStringProperty(uri, err, o, "uri", true)) {
-    return false;
+bool EntryParser::ParseSceneEntry(Section section, const std::string &key,
+                                  const JsonObject &o) {
+  const int handle = resolver_.Intern(section, key);
+  std::vector<char> &defined = defined_[section];
+  if (defined.size() <= static_cast<size_t>(handle)) {
+    defined.resize(handle + 1, 0);
   }
+  defined[handle] = 1;
+
+  switch (section) {
+  case SECTION_BUFFERS: {
+    // glTF 2.0 refers to the body as the first buffer, which has no uri.
+    const bool isBinaryBody =
+        loader_.binaryBody_ &&
+        (resolver_.indexed()
+             ? ((key.compare("0") == 0) && (o.find("uri") == o.end()))
+             : (key.compare("binary_glTF") == 0));
+
+    Buffer &buffer = scene_.buffers[handle];
+    PendingBuffer pending;
+    if (!ParseBuffer(buffer, err_, o,
+                     isBinaryBody ? loader_.binaryBody_ : NULL,
+                     loader_.binaryBodyLength_, loader_.binaryOwner_,
+                     !loader_.scanSummary_, pending.uri, pending.byteLength)) {
+      return false;
+    }
 
-  ParseStringProperty(image.name, err, o, "name", false);
+    bufferBytes_ += pending.byteLength;
 
-  std::vector<unsigned char> img;
-  if (IsDataURI(uri)) {
-    if (!DecodeDataURI(img, uri, 0, false)) {
-      err += "Failed to decode 'uri'.\n";
-      return false;
+    if (!pending.uri.empty()) {
+      prefetcher_.Request(pending.uri);
+      pending.buffer = handle;
+      pendingBuffers_.push_back(pending);
     }
-  } else {
-    // Assume external file
-    if (!LoadExternalFile(img, err, uri, basedir, 0, false)) {
-      err += "Failed to load external 'uri'.\n";
+    return true;
+  }
+  case SECTION_BUFFER_VIEWS:
+    return ParseBufferView(scene_.bufferViews[handle], err_, o, resolver_);
+  case SECTION_ACCESSORS:
+    return ParseAccessor(scene_.accessors[handle], err_, o, resolver_);
+  case SECTION_MESHES:
+    return ParseMesh(scene_.meshes[handle], err_, o, resolver_);
+  case SECTION_NODES: {
+    // Interning children may grow the node table, so the node is parsed
+    // aside instead of through a reference into it.
+    Node node;
+    if (!ParseNode(node, err_, o, resolver_)) {
       return false;
     }
-    if (img.empty()) {
-      err += "File is empty.\n";
+    std::swap(scene_.nodes[handle], node);
+    return true;
+  }
+  case SECTION_SCENES:
+    scene_.scenes[handle].clear();
+    return ParseHandleArrayProperty(scene_.scenes[handle], err_, o, "nodes",
+                                    false, resolver_, SECTION_NODES);
+  case SECTION_MATERIALS:
+    if (resolver_.indexed()) {
+      return ParseMaterial2(scene_.materials[handle], err_, o);
+    }
+    return ParseMaterial(scene_.materials[handle], err_, o);
+  case SECTION_IMAGES: {
+    Image &image = scene_.images[handle];
+    if (!ParseImage(image, err_, o, baseDir_, resolver_)) {
       return false;
     }
-  }
 
-  int w, h, comp;
-  unsigned char *data =
-      stbi_load_from_memory(&img.at(0), img.size(), &w, &h, &comp, 0);
-  if (!data) {
-    err += "Unknown image format.\n";
-    return false;
+    // Images are only read during the load when they are also decoded then.
+    if (loader_.decodeImagesOnLoad_ && !loader_.scanSummary_ &&
+        (image.bufferView < 0)) {
+      prefetcher_.Request(image.uri);
+    }
+    return true;
+  }
+  case SECTION_TEXTURES:
+    return ParseTexture(scene_.textures[handle], err_, o, baseDir_,
+                        resolver_);
+  default:
+    return true;
   }
+}
 
-  if (w < 1 || h < 1) {
-    err += "Unknown image format.\n";
-    return false;
+
+/// Fills a Scene from a glTF document. Top-level values other than sections
+/// are parsed right away or skipped without allocating. Small documents, or
+/// any document without several workers to parse it, have their section
+/// entries converted by an EntryParser while the document is read. Otherwise
+/// the first pass over the document only locates the entries of the sections
+/// and splits them into chunks, which are then converted concurrently on the
+/// loader's worker pool, each into a private partition of the scene. The
+/// partitions are merged in document order, so the result is the same as
+/// when parsing serially. External buffers are only waited for once all
+/// entries have been parsed.
+class SceneParser {
+public:
+  SceneParser(const TinyGLTFLoader &loader, Scene &scene, std::string &err,
+              const std::string &baseDir, ResourcePrefetcher &prefetcher)
+      : loader_(loader), scene_(scene), err_(err), baseDir_(baseDir),
+        prefetcher_(prefetcher), json_(arena_), last_(NULL),
+        sectionCount_(kProfileSectionCounts[loader.loadProfile_]),
+        resolver_(scene, sectionCount_),
+        entries_(loader, scene, resolver_, baseDir, prefetcher),
+        parallel_(false), hasIndexedSection_(false),
+        hasDefaultScene_(false), defaultSceneIndex_(0.0), failed_(false) {
+    for (int i = 0; i < SECTION_COUNT; i++) {
+      hasSection_[i] = false;
+    }
   }
 
-  image.width = w;
-  image.height = h;
-  image.component = comp;
-  image.image.resize(w * h * comp);
-  std::copy(data, data + w * h * comp, image.image.begin());
+  /// Parses the document in [first, last) into the scene.
+  /// Returns false and set error string to `err` if there's an error.
+  bool Parse(const char *first, const char *last);
+
+  // Called by the parse context.
+  bool ParseTopLevel(picojson::input<const char *> &in,
+                     const std::string &key);
+
+private:
+  SceneParser(const SceneParser &);
+  SceneParser &operator=(const SceneParser &);
+
+  /// A chunk parsed on its own into a scene of its own.
+  struct Partition {
+    Partition(SceneParser &parser)
+        : resolver(scene, parser.sectionCount_),
+          entries(parser.loader_, scene, resolver, parser.baseDir_,
+                  parser.prefetcher_),
+          ok(false) {
+      resolver.SetIndexed(parser.resolver_.indexed());
+    }
 
-  return true;
-}
+    Scene scene;
+    HandleResolver resolver;
+    EntryParser entries;
+    bool ok;
+  };
+
+  bool LocateSection(picojson::input<const char *> &in, Section section);
+  bool BeginSection(Section section, bool indexed);
+  bool ParseSections();
+  void InternPartitions(
+      const std::vector<std::unique_ptr<Partition> > &partitions,
+      std::vector<HandleRemap> &remaps, Section section);
+  void MergePartitions(
+      const std::vector<std::unique_ptr<Partition> > &partitions,
+      const std::vector<HandleRemap> &remaps, Section section);
+  template <typename T>
+  void MergeEntries(SceneTable<T> &table, SceneTable<T> &entries,
+                    Section section, const std::vector<char> &defined,
+                    const HandleRemap &remap);
+  void TakeResults(EntryParser &entries, const HandleRemap *remap);
+  bool Finish();
+  template <typename T>
+  bool CheckDefined(const SceneTable<T> &table, Section section);
+
+  const TinyGLTFLoader &loader_;
+  Scene &scene_;
+  std::string &err_;
+  const std::string &baseDir_;
+  ResourcePrefetcher &prefetcher_;
+
+  // Holds top-level values other than sections while they are parsed.
+  JsonArena arena_;
+  JsonBuilder json_;
+
+  const char *last_; // End of the document.
+  const int sectionCount_; // Sections read by the loader's profile.
+  HandleResolver resolver_;
+  EntryParser entries_; // Parses the sections when they are not split.
+  bool parallel_;       // Sections are split into chunks_ instead.
+  std::vector<SectionChunk> chunks_; // In document order.
+
+  std::vector<char> defined_[SECTION_COUNT]; // Indexed by handle.
+  std::vector<EntryParser::PendingBuffer> pendingBuffers_;
+  bool hasSection_[SECTION_COUNT];
+  bool hasIndexedSection_; // The first section seen was an array (glTF 2.0).
+
+  // The "scene" property, resolved once the scenes have been parsed.
+  bool hasDefaultScene_;
+  std::string defaultSceneId_;
+  double defaultSceneIndex_;
+
+  bool failed_; // Parsing stopped because of an error in `err_`.
+};
 
-bool ParseTexture(Texture &texture, std::string &err, const picojson::object &o,
-                  const std::string &basedir) {
+/// Dispatches the members of the document's root object to SceneParser.
+/// Values it has no callback for are skipped.
+class DocumentParseContext : public picojson::null_parse_context {
+public:
+  explicit DocumentParseContext(SceneParser &parser) : parser_(parser) {}
 
-  if (!ParseStringProperty(texture.sampler, err, o, "sampler", true)) {
-    return false;
+  bool parse_object_item(picojson::input<const char *> &in,
+                         const std::string &key) {
+    return parser_.ParseTopLevel(in, key);
   }
 
-  if (!ParseStringProperty(texture.source, err, o, "source", true)) {
+private:
+  SceneParser &parser_;
+};
+
+bool SceneParser::Parse(const char *first, const char *last) {
+  // Entries are parsed directly into their table slots, so start from an
+  // empty scene instead of overwriting whatever a previous load left behind.
+  scene_.buffers.clear();
+  scene_.bufferViews.clear();
+  scene_.accessors.clear();
+  scene_.meshes.clear();
+  scene_.nodes.clear();
+  scene_.textures.clear();
+  scene_.images.clear();
+  scene_.materials.clear();
+  scene_.scenes.clear();
+  scene_.accessorViews.clear();
+  scene_.defaultScene = -1;
+
+  // Workers only pay off when there are several of them and enough chunks to
+  // keep them busy.
+  last_ = last;
+  parallel_ =
+      (static_cast<size_t>(last - first) >= 4 * kSectionChunkSize) &&
+      (loader_.parallelFor_ || (std::thread::hardware_concurrency() > 1));
+
+  DocumentParseContext ctx(*this);
+  std::string perr;
+  picojson::_parse(ctx, first, last, &perr);
+  if (failed_) {
+    return false;
+  }
+  if (!perr.empty()) {
+    err_ = perr;
     return false;
   }
 
-  ParseStringProperty(texture.name, err, o, "name", false);
-
-  double format = TINYGLTF_TEXTURE_FORMAT_RGBA;
-  ParseNumberProperty(format, err, o, "format", false);
+  if (!ParseSections()) {
+    return false;
+  }
 
-  double internalFormat = TINYGLTF_TEXTURE_FORMAT_RGBA;
-  ParseNumberProperty(internalFormat, err, o, "internalFormat", false);
+  return Finish();
+}
 
-  double target = TINYGLTF_TEXTURE_TARGET_TEXTURE2D;
-  ParseNumberProperty(target, err, o, "target", false);
+bool SceneParser::ParseTopLevel(picojson::input<const char *> &in,
+                                const std::string &key) {
+  for (int i = 0; i < sectionCount_; i++) {
+    if (key.compare(kSectionNames[i]) == 0) {
+      return LocateSection(in, static_cast<Section>(i));
+    }
+  }
 
-  double type = TINYGLTF_TEXTURE_TYPE_UNSIGNED_BYTE;
-  ParseNumberProperty(type, err, o, "type", false);
+  if ((key.compare("scene") == 0) || (key.compare("asset") == 0)) {
+    arena_.Reset();
+    JsonValue v;
+    if (!json_.Parse(v, in)) {
+      return false;
+    }
 
-  texture.format = static_cast<int>(format);
-  texture.internalFormat = static_cast<int>(internalFormat);
-  texture.target = static_cast<int>(target);
-  texture.type = static_cast<int>(type);
+    if (v.is<JsonString>() && (key.compare("scene") == 0)) {
+      defaultSceneId_ = v.get<JsonString>().str();
+      hasDefaultScene_ = true;
+    } else if (v.is<double>() && (key.compare("scene") == 0)) {
+      defaultSceneIndex_ = v.get<double>();
+      hasDefaultScene_ = true;
+    } else if (v.is<JsonObject>() && (key.compare("asset") == 0)) {
+      ParseAsset(scene_.asset, err_, v.get<JsonObject>());
+    }
+    return true;
+  }
 
-  return true;
+  picojson::null_parse_context ctx;
+  return picojson::_parse(ctx, in);
 }
 
-bool ParseBuffer(Buffer &buffer, std::string &err, const picojson::object &o,
-                 const std::string &basedir) {
-  double byteLength;
-  if (!ParseNumberProperty(byteLength, err, o, "byteLength", true)) {
-    return false;
+bool SceneParser::LocateSection(picojson::input<const char *> &in,
+                                Section section) {
+  in.skip_ws();
+  const int open = in.getc();
+  if ((open != '{') && (open != '[')) {
+    // Not a section after all; skipped like other values.
+    in.ungetc();
+    picojson::null_parse_context ctx;
+    return picojson::_parse(ctx, in);
   }
 
-  std::string uri;
-  if (!ParseStringProperty(uri, err, o, "uri", true)) {
+  // glTF 1.0 sections are objects keyed by id, glTF 2.0 ones are arrays.
+  if (!BeginSection(section, open == '[')) {
     return false;
   }
 
-  picojson::object::const_iterator type = o.find("type");
-  if (type != o.end()) {
-    if (type->second.is<std::string>()) {
-      const std::string &ty = (type->second).get<std::string>();
-      if (ty.compare("arraybuffer") == 0) {
-        // buffer.type = "arraybuffer";
-      }
-    }
-  }
-
-  size_t bytes = static_cast<size_t>(byteLength);
-  if (IsDataURI(uri)) {
-    if (!DecodeDataURI(buffer.data, uri, bytes, true)) {
-      err += "Failed to decode 'uri'.\n";
-      return false;
+  const int close = (open == '[') ? ']' : '}';
+  if (!parallel_) {
+    // Not worth splitting; the entries are converted as they are read.
+    if (entries_.ParseSection(in, section, close)) {
+      return true;
     }
-  } else {
-    // Assume external .bin file.
-    if (!LoadExternalFile(buffer.data, err, uri, basedir, bytes, true)) {
-      return false;
+    if (entries_.failed_) {
+      err_ += entries_.err_;
+      failed_ = true;
     }
+    return false;
   }
 
-  ParseStringProperty(buffer.name, err, o, "name", false);
+  int line = in.line();
+  const char *end =
+      SplitSection(chunks_, section, in.cur(), last_, close, line);
+  if (!end) {
+    return false;
+  }
 
+  in.seek(end, line);
   return true;
 }
 
-bool ParseBufferView(BufferView &bufferView, std::string &err,
-                     const picojson::object &o) {
-  std::string buffer;
-  if (!ParseStringProperty(buffer, err, o, "buffer", true)) {
-    return false;
+bool SceneParser::BeginSection(Section section, bool indexed) {
+  bool first = true;
+  for (int i = 0; i < SECTION_COUNT; i++) {
+    first = first && !hasSection_[i];
   }
-
-  double byteOffset;
-  if (!ParseNumberProperty(byteOffset, err, o, "byteOffset", true)) {
+  hasSection_[section] = true;
+
+  if (first) {
+    hasIndexedSection_ = indexed;
+    resolver_.SetIndexed(indexed);
+  } else if (indexed != hasIndexedSection_) {
+    err_ += std::string("\"") + kSectionNames[section] +
+            "\" does not match the glTF version of the other sections.\n";
+    failed_ = true;
     return false;
   }
 
-  double byteLength = 0.0;
-  ParseNumberProperty(byteLength, err, o, "byteLength", false);
+  return true;
+}
 
-  double target = 0.0;
-  ParseNumberProperty(target, err, o, "target", false);
-  int targetValue = static_cast<int>(target);
-  if ((targetValue == TINYGLTF_TARGET_ARRAY_BUFFER) ||
-      (targetValue == TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER)) {
-    // OK
-  } else {
-    targetValue = 0;
+bool SceneParser::ParseSections() {
+  if (!parallel_) {
+    TakeResults(entries_, NULL);
+    return true;
   }
-  bufferView.target = targetValue;
 
-  ParseStringProperty(bufferView.name, err, o, "name", false);
+  std::vector<std::unique_ptr<Partition> > partitions(chunks_.size());
+  loader_.ParallelFor(partitions.size(), [&](size_t i) {
+    partitions[i].reset(new Partition(*this));
+    partitions[i]->ok = partitions[i]->entries.Parse(chunks_[i]);
+  });
+
+  // Report the error a serial parse would have stopped at.
+  for (size_t i = 0; i < partitions.size(); i++) {
+    if (!partitions[i]->ok) {
+      err_ += partitions[i]->entries.err_;
+      return false;
+    }
+  }
 
-  bufferView.buffer = buffer;
-  bufferView.byteOffset = static_cast<size_t>(byteOffset);
-  bufferView.byteLength = static_cast<size_t>(byteLength);
+  // Interning is ordered within a table but independent between tables, and
+  // entries only move into the table of their own section, so both steps of
+  // the merge run one task per section.
+  std::vector<HandleRemap> remaps(partitions.size());
+  for (size_t i = 0; i < remaps.size(); i++) {
+    remaps[i].indexed = resolver_.indexed();
+  }
+  loader_.ParallelFor(sectionCount_, [&](size_t i) {
+    InternPartitions(partitions, remaps, static_cast<Section>(i));
+  });
+  loader_.ParallelFor(sectionCount_, [&](size_t i) {
+    MergePartitions(partitions, remaps, static_cast<Section>(i));
+  });
+
+  for (size_t i = 0; i < partitions.size(); i++) {
+    resolver_.AddReferences(partitions[i]->resolver);
+    TakeResults(partitions[i]->entries, &remaps[i]);
+  }
 
   return true;
 }
 
-bool ParseAccessor(Accessor &accessor, std::string &err,
-                   const picojson::object &o) {
-  std::string bufferView;
-  if (!ParseStringProperty(bufferView, err, o, "bufferView", true)) {
-    return false;
-  }
+// Interns the ids the partitions saw in `section` into the scene, in the
+// order each partition first saw them. Partitions are in document order, so
+// every id ends up with the handle a serial parse would have given it.
+void SceneParser::InternPartitions(
+    const std::vector<std::unique_ptr<Partition> > &partitions,
+    std::vector<HandleRemap> &remaps, Section section) {
+  for (size_t i = 0; i < partitions.size(); i++) {
+    // glTF 2.0 references are indices already, only the entries need names.
+    if (remaps[i].indexed && (chunks_[i].section != section)) {
+      continue;
+    }
 
-  double byteOffset;
-  if (!ParseNumberProperty(byteOffset, err, o, "byteOffset", true)) {
-    return false;
+    const HandleResolver &resolver = partitions[i]->resolver;
+    std::vector<int> &handles = remaps[i].handles[section];
+    handles.resize(resolver.Size(section));
+    for (size_t h = 0; h < handles.size(); h++) {
+      const std::string &id = resolver.Name(section, static_cast<int>(h));
+      handles[h] = resolver_.Intern(section, id);
+    }
   }
+}
 
-  double componentType;
-  if (!ParseNumberProperty(componentType, err, o, "componentType", true)) {
-    return false;
+// Moves the entries of `section` out of the partitions into the scene.
+void SceneParser::MergePartitions(
+    const std::vector<std::unique_ptr<Partition> > &partitions,
+    const std::vector<HandleRemap> &remaps, Section section) {
+  for (size_t i = 0; i < partitions.size(); i++) {
+    if (chunks_[i].section != section) {
+      continue;
+    }
+
+    Scene &entries = partitions[i]->scene;
+    const std::vector<char> &defined =
+        partitions[i]->entries.defined_[section];
+    const HandleRemap &remap = remaps[i];
+    switch (section) {
+    case SECTION_BUFFERS:
+      MergeEntries(scene_.buffers, entries.buffers, section, defined, remap);
+      break;
+    case SECTION_BUFFER_VIEWS:
+      MergeEntries(scene_.bufferViews, entries.bufferViews, section, defined,
+                   remap);
+      break;
+    case SECTION_ACCESSORS:
+      MergeEntries(scene_.accessors, entries.accessors, section, defined,
+                   remap);
+      break;
+    case SECTION_MESHES:
+      MergeEntries(scene_.meshes, entries.meshes, section, defined, remap);
+      break;
+    case SECTION_NODES:
+      MergeEntries(scene_.nodes, entries.nodes, section, defined, remap);
+      break;
+    case SECTION_SCENES:
+      MergeEntries(scene_.scenes, entries.scenes, section, defined, remap);
+      break;
+    case SECTION_MATERIALS:
+      MergeEntries(scene_.materials, entries.materials, section, defined,
+                   remap);
+      break;
+    case SECTION_IMAGES:
+      MergeEntries(scene_.images, entries.images, section, defined, remap);
+      break;
+    case SECTION_TEXTURES:
+      MergeEntries(scene_.textures, entries.textures, section, defined,
+                   remap);
+      break;
+    default:
+      break;
+    }
   }
+}
 
-  double count = 0.0;
-  if (!ParseNumberProperty(count, err, o, "count", true)) {
-    return false;
+template <typename T>
+void SceneParser::MergeEntries(SceneTable<T> &table, SceneTable<T> &entries,
+                               Section section,
+                               const std::vector<char> &defined,
+                               const HandleRemap &remap) {
+  std::vector<char> &merged = defined_[section];
+  for (size_t i = 0; i < defined.size(); i++) {
+    if (!defined[i]) {
+      continue;
+    }
+
+    const int handle = remap.handles[section][i];
+    RemapHandles(entries[static_cast<int>(i)], remap);
+    std::swap(table[handle], entries[static_cast<int>(i)]);
+    if (merged.size() <= static_cast<size_t>(handle)) {
+      merged.resize(handle + 1, 0);
+    }
+    merged[handle] = 1;
   }
+}
 
-  std::string type;
-  if (!ParseStringProperty(type, err, o, "type", true)) {
-    return false;
+// Collects what `entries` found besides the entries themselves. Without
+// `remap` they were parsed into the scene itself.
+void SceneParser::TakeResults(EntryParser &entries, const HandleRemap *remap) {
+  if (!remap) {
+    for (int i = 0; i < SECTION_COUNT; i++) {
+      defined_[i].swap(entries.defined_[i]);
+    }
   }
 
-  if (type.compare("SCALAR") == 0) {
-    accessor.type = TINYGLTF_TYPE_SCALAR;
-  } else if (type.compare("VEC2") == 0) {
-    accessor.type = TINYGLTF_TYPE_VEC2;
-  } else if (type.compare("VEC3") == 0) {
-    accessor.type = TINYGLTF_TYPE_VEC3;
-  } else if (type.compare("VEC4") == 0) {
-    accessor.type = TINYGLTF_TYPE_VEC4;
-  } else if (type.compare("MAT2") == 0) {
-    accessor.type = TINYGLTF_TYPE_MAT2;
-  } else if (type.compare("MAT3") == 0) {
-    accessor.type = TINYGLTF_TYPE_MAT3;
-  } else if (type.compare("MAT4") == 0) {
-    accessor.type = TINYGLTF_TYPE_MAT4;
-  } else {
-    std::stringstream ss;
-    ss << "Unsupported `type` for accessor object. Got \"" << type << "\"\n";
-    err += ss.str();
-    return false;
+  for (size_t i = 0; i < entries.pendingBuffers_.size(); i++) {
+    EntryParser::PendingBuffer &pending = entries.pendingBuffers_[i];
+    if (remap) {
+      pending.buffer = remap->handles[SECTION_BUFFERS][pending.buffer];
+    }
+    pendingBuffers_.push_back(pending);
   }
 
-  double byteStride = 0.0;
-  ParseNumberProperty(byteStride, err, o, "byteStride", false);
+  if (loader_.scanSummary_) {
+    loader_.scanSummary_->bufferBytes += entries.bufferBytes_;
+  }
 
-  ParseStringProperty(accessor.name, err, o, "name", false);
+  // Messages about properties which were ignored.
+  err_ += entries.err_;
+}
 
-  accessor.minValues.clear();
-  accessor.maxValues.clear();
-  ParseNumberArrayProperty(accessor.minValues, err, o, "min", false);
-  ParseNumberArrayProperty(accessor.maxValues, err, o, "max", false);
+bool SceneParser::Finish() {
+  // Every top-level property is optional in glTF 2.0, which a document
+  // without any section can only tell by its asset version.
+  const bool indexed = resolver_.indexed() ||
+                       (scene_.asset.version.compare(0, 1, "2") == 0);
 
-  accessor.count = static_cast<size_t>(count);
-  accessor.bufferView = bufferView;
-  accessor.byteOffset = static_cast<size_t>(byteOffset);
-  accessor.byteStride = static_cast<size_t>(byteStride);
+  if (!indexed && !hasDefaultScene_) {
+    err_ += "\"scene\" object not found in .gltf\n";
+    return false;
+  }
 
-  {
-    int comp = static_cast<size_t>(componentType);
-    if (comp >= TINYGLTF_COMPONENT_TYPE_BYTE &&
-        comp <= TINYGLTF_COMPONENT_TYPE_DOUBLE) {
-      // OK
-      accessor.componentType = comp;
-    } else {
-      std::stringstream ss;
-      ss << "Invalid `componentType` in accessor. Got " << comp << "\n";
-      err += ss.str();
+  const Section required[] = {SECTION_SCENES, SECTION_NODES,
+                              SECTION_ACCESSORS, SECTION_BUFFERS,
+                              SECTION_BUFFER_VIEWS};
+  for (size_t i = 0;
+       !indexed && (i < sizeof(required) / sizeof(required[0])); i++) {
+    if (!hasSection_[required[i]]) {
+      err_ += std::string("\"") + kSectionNames[required[i]] +
+              "\" object not found in .gltf\n";
+      return false;
+    }
+  }
+
+  if (hasDefaultScene_ && resolver_.indexed()) {
+    if (!resolver_.InternIndex(SECTION_SCENES, defaultSceneIndex_,
+                               scene_.defaultScene)) {
+      err_ += "'scene' property is not a valid reference.\n";
       return false;
     }
+  } else if (hasDefaultScene_) {
+    scene_.defaultScene = resolver_.Intern(SECTION_SCENES, defaultSceneId_);
   }
 
-  return true;
-}
+  // glTF 2.0 entries are all defined, but references may point past them.
+  for (int i = 0; resolver_.indexed() && (i < sectionCount_); i++) {
+    const Section section = static_cast<Section>(i);
+    if (resolver_.referenced(section) > resolver_.Size(section)) {
+      std::stringstream ss;
+      ss << "Index " << (resolver_.referenced(section) - 1)
+         << " is out of range of \"" << kSectionNames[section] << "\".\n";
+      err_ += ss.str();
+      return false;
+    }
+  }
 
-bool ParsePrimitive(Primitive &primitive, std::string &err,
-                    const picojson::object &o) {
-  if (!ParseStringProperty(primitive.material, err, o, "material", true)) {
+  if (!CheckDefined(scene_.buffers, SECTION_BUFFERS) ||
+      !CheckDefined(scene_.bufferViews, SECTION_BUFFER_VIEWS) ||
+      !CheckDefined(scene_.accessors, SECTION_ACCESSORS) ||
+      !CheckDefined(scene_.meshes, SECTION_MESHES) ||
+      !CheckDefined(scene_.nodes, SECTION_NODES) ||
+      !CheckDefined(scene_.scenes, SECTION_SCENES) ||
+      !CheckDefined(scene_.materials, SECTION_MATERIALS) ||
+      !CheckDefined(scene_.images, SECTION_IMAGES) ||
+      !CheckDefined(scene_.textures, SECTION_TEXTURES)) {
     return false;
   }
 
-  double mode = static_cast<double>(TINYGLTF_MODE_TRIANGLES);
-  ParseNumberProperty(mode, err, o, "mode", false);
+  for (size_t i = 0; i < pendingBuffers_.size(); i++) {
+    const EntryParser::PendingBuffer &pending = pendingBuffers_[i];
+    if (!LoadBufferFile(scene_.buffers[pending.buffer], err_, pending.uri,
+                        pending.byteLength, baseDir_,
+                        loader_.useMemoryMapping_,
+                        loader_.resourceCache_.get(), &prefetcher_)) {
+      return false;
+    }
+  }
 
-  int primMode = static_cast<int>(mode);
-  if (primMode != TINYGLTF_MODE_TRIANGLES) {
-    err += "Currently TinyGLTFLoader doesn not support primitive mode other \n"
-           "than TRIANGLES.\n";
+  // A scan does not read buffers, so there is nothing to locate.
+  if (!loader_.scanSummary_ && !ResolveAccessorViews(scene_, err_)) {
     return false;
   }
-  primitive.mode = primMode;
-
-  primitive.indices = "";
-  ParseStringProperty(primitive.indices, err, o, "indices", false);
 
-  primitive.attributes.clear();
-  picojson::object::const_iterator attribsObject = o.find("attributes");
-  if ((attribsObject != o.end()) &&
-      (attribsObject->second).is<picojson::object>()) {
-    const picojson::object &attribs =
-        (attribsObject->second).get<picojson::object>();
-    picojson::object::const_iterator it(attribs.begin());
-    picojson::object::const_iterator itEnd(attribs.end());
-    for (; it != itEnd; it++) {
-      const std::string &name = it->first;
-      if (!(it->second).is<std::string>()) {
-        err += "attribute expects string value.\n";
-        return false;
-      }
-      const std::string &value = (it->second).get<std::string>();
+  return true;
+}
 
-      primitive.attributes[name] = value;
+// Handles are handed out for references too, so an id which was referenced
+// but never defined leaves a default constructed entry behind.
+template <typename T>
+bool SceneParser::CheckDefined(const SceneTable<T> &table, Section section) {
+  const std::vector<char> &defined = defined_[section];
+  for (size_t i = 0; i < table.size(); i++) {
+    if ((i >= defined.size()) || !defined[i]) {
+      err_ += "\"" + table.name(static_cast<int>(i)) +
+              "\" is referenced but not defined in \"" +
+              kSectionNames[section] + "\".\n";
+      return false;
     }
   }
 
   return true;
 }
 
-bool ParseMesh(Mesh &mesh, std::string &err, const picojson::object &o) {
-  ParseStringProperty(mesh.name, err, o, "name", false);
+} // namespace tinygltf
 
-  mesh.primitives.clear();
-  picojson::object::const_iterator primObject = o.find("primitives");
-  if ((primObject != o.end()) && (primObject->second).is<picojson::array>()) {
-    const picojson::array &primArray =
-        (primObject->second).get<picojson::array>();
-    for (size_t i = 0; i < primArray.size(); i++) {
-      Primitive primitive;
-      ParsePrimitive(primitive, err, primArray[i].get<picojson::object>());
-      mesh.primitives.push_back(primitive);
-    }
+bool TinyGLTFLoader::LoadFromString(Scene &scene, std::string &err,
+                                    const char *str, unsigned int length,
+                                    const std::string &baseDir) {
+  // External resources are read in the background as soon as the document
+  // refers to them.
+  ResourcePrefetcher prefetcher(baseDir, useMemoryMapping_,
+                                resourceCache_.get());
+
+  SceneParser parser(*this, scene, err, baseDir, prefetcher);
+  if (!parser.Parse(str, str + length)) {
+    return false;
+  }
+
+  if (decodeImagesOnLoad_ && !scanSummary_ &&
+      !DecodeImages(scene, err, &prefetcher)) {
+    return false;
   }
 
   return true;
 }
 
-bool ParseNode(Node &node, std::string &err, const picojson::object &o) {
-  ParseStringProperty(node.name, err, o, "name", false);
+bool TinyGLTFLoader::LoadFromFile(Scene &scene, std::string &err,
+                                  const std::string &filename) {
+  std::shared_ptr<MappedFile> f(new MappedFile);
+  if (!f->Open(err, filename, useMemoryMapping_)) {
+    return false;
+  }
 
-  ParseNumberArrayProperty(node.rotation, err, o, "rotation", false);
-  ParseNumberArrayProperty(node.scale, err, o, "scale", false);
-  ParseNumberArrayProperty(node.translation, err, o, "translation", false);
-  ParseNumberArrayProperty(node.matrix, err, o, "matrix", false);
-  ParseStringArrayProperty(node.meshes, err, o, "meshes", false);
+  std::string basedir = GetBaseDir(filename);
 
-  node.children.clear();
-  picojson::object::const_iterator childrenObject = o.find("children");
-  if ((childrenObject != o.end()) &&
-      (childrenObject->second).is<picojson::array>()) {
-    const picojson::array &childrenArray =
-        (childrenObject->second).get<picojson::array>();
-    for (size_t i = 0; i < childrenArray.size(); i++) {
-      Node node;
-      if (!childrenArray[i].is<std::string>()) {
-        err += "Invalid `children` array.\n";
-        return false;
-      }
-      const std::string &childrenNode = childrenArray[i].get<std::string>();
-      node.children.push_back(childrenNode);
-    }
+  if (IsBinary(f->data(), f->size())) {
+    // The scene's binary buffer keeps the file contents alive.
+    return LoadBinaryFromMemory(scene, err, f->data(),
+                                static_cast<unsigned int>(f->size()), basedir,
+                                f);
   }
 
-  return true;
+  bool ret = LoadFromString(scene, err,
+                            reinterpret_cast<const char *>(f->data()),
+                            static_cast<unsigned int>(f->size()), basedir);
+
+  return ret;
 }
 
-bool ParseMaterial(Material &material, std::string &err,
-                   const picojson::object &o) {
-  ParseStringProperty(material.name, err, o, "name", false);
-  ParseStringProperty(material.technique, err, o, "technique", false);
+bool TinyGLTFLoader::ScanFromFile(SceneSummary &summary, std::string &err,
+                                  const std::string &filename) {
+  summary = SceneSummary();
 
-  material.values.clear();
-  picojson::object::const_iterator valuesIt = o.find("values");
-  if ((valuesIt != o.end()) && (valuesIt->second).is<picojson::object>()) {
+  Scene scene;
+  scanSummary_ = &summary;
+  bool ret = LoadFromFile(scene, err, filename);
+  scanSummary_ = NULL;
+  if (!ret) {
+    return false;
+  }
 
-    const picojson::object &valuesObject =
-        (valuesIt->second).get<picojson::object>();
-    picojson::object::const_iterator it(valuesObject.begin());
-    picojson::object::const_iterator itEnd(valuesObject.end());
+  summary.meshes = scene.meshes.size();
+  summary.nodes = scene.nodes.size();
+  summary.materials = scene.materials.size();
+  summary.textures = scene.textures.size();
+  summary.images = scene.images.size();
+  summary.accessors = scene.accessors.size();
+  summary.buffers = scene.buffers.size();
+
+  for (size_t i = 0; i < scene.accessors.size(); i++) {
+    const Accessor &a = scene.accessors[static_cast<int>(i)];
+    summary.accessorBytes += a.count * GetTypeComponentCount(a.type) *
+                             GetComponentSizeInBytes(a.componentType);
+  }
 
-    for (; it != itEnd; it++) {
-      // Assume number values.
-      Parameter param;
-      if (ParseStringProperty(param.stringValue, err, valuesObject, it->first,
-                              false)) {
-        // Found string property.
-      } else if (!ParseNumberArrayProperty(param.numberArray, err, valuesObject,
-                                           it->first, false)) {
-        // Fallback to numer property.
-        double value;
-        if (ParseNumberProperty(value, err, valuesObject, it->first, false)) {
-          param.numberArray.push_back(value);
+  for (size_t m = 0; m < scene.meshes.size(); m++) {
+    const std::vector<Primitive> &primitives =
+        scene.meshes[static_cast<int>(m)].primitives;
+    summary.primitives += primitives.size();
+    for (size_t i = 0; i < primitives.size(); i++) {
+      // Lists take three corners per triangle, while strips and fans add
+      // one per corner after the first two. Non-indexed primitives have a
+      // corner per vertex.
+      const Primitive &primitive = primitives[i];
+      int corners = primitive.indices;
+      if (corners < 0) {
+        std::map<std::string, int>::const_iterator position =
+            primitive.attributes.find("POSITION");
+        if (position != primitive.attributes.end()) {
+          corners = position->second;
+        }
+      }
+      if (corners >= 0) {
+        size_t count = scene.accessors[corners].count;
+        if (primitive.mode == TINYGLTF_MODE_TRIANGLES) {
+          summary.triangles += count / 3;
+        } else if (count > 2) {
+          summary.triangles += count - 2;
         }
       }
-
-      material.values[it->first] = param;
     }
   }
 
   return true;
 }
+
+bool TinyGLTFLoader::DecodeImage(Image &image, std::string &err,
+                                 const Scene &scene) {
+  if (image.decoded()) {
+    return true;
+  }
+
+  return DecodeImageData(image, err, scene, useMemoryMapping_,
+                         resourceCache_.get(), NULL);
 }
 
-bool TinyGLTFLoader::LoadFromString(Scene &scene, std::string &err,
-                                    const char *str, unsigned int length,
-                                    const std::string &baseDir) {
-  picojson::value v;
-  std::string perr = picojson::parse(v, str, str + length);
+bool TinyGLTFLoader::DecodeImages(Scene &scene, std::string &err) {
+  return DecodeImages(scene, err, NULL);
+}
 
-  if (!perr.empty()) {
-    err = perr;
-    return false;
+bool TinyGLTFLoader::DecodeImages(Scene &scene, std::string &err,
+                                  ResourcePrefetcher *prefetcher) {
+  std::vector<Image *> pending;
+  for (size_t i = 0; i < scene.images.size(); i++) {
+    Image &image = scene.images[static_cast<int>(i)];
+    if (!image.decoded()) {
+      pending.push_back(&image);
+    }
   }
 
-  if (v.contains("scene") && v.get("scene").is<std::string>()) {
-    // OK
-  } else {
-    err += "\"scene\" object not found in .gltf\n";
-    return false;
+  // Each task only writes its own image and error slot.
+  std::vector<std::string> errors(pending.size());
+  std::vector<char> succeeded(pending.size(), 0);
+  ParallelFor(pending.size(), [&](size_t i) {
+    succeeded[i] =
+        DecodeImageData(*pending[i], errors[i], scene, useMemoryMapping_,
+                        resourceCache_.get(), prefetcher);
+  });
+
+  bool ret = true;
+  for (size_t i = 0; i < pending.size(); i++) {
+    err += errors[i];
+    ret = ret && succeeded[i];
   }
 
-  if (v.contains("scenes") && v.get("scenes").is<picojson::object>()) {
-    // OK
-  } else {
-    err += "\"scenes\" object not found in .gltf\n";
-    return false;
-  }
+  return ret;
+}
 
-  if (v.contains("nodes") && v.get("nodes").is<picojson::object>()) {
-    // OK
-  } else {
-    err += "\"nodes\" object not found in .gltf\n";
-    return false;
+void TinyGLTFLoader::ParallelFor(
+    size_t count, const std::function<void(size_t)> &task) const {
+  if (count == 0) {
+    return;
   }
 
-  if (v.contains("accessors") && v.get("accessors").is<picojson::object>()) {
-    // OK
-  } else {
-    err += "\"accessors\" object not found in .gltf\n";
-    return false;
+  if (parallelFor_) {
+    parallelFor_(count, task);
+    return;
   }
 
-  if (v.contains("buffers") && v.get("buffers").is<picojson::object>()) {
-    // OK
-  } else {
-    err += "\"buffers\" object not found in .gltf\n";
-    return false;
+  size_t numThreads = std::thread::hardware_concurrency();
+  if (numThreads > count) {
+    numThreads = count;
   }
-
-  if (v.contains("bufferViews") &&
-      v.get("bufferViews").is<picojson::object>()) {
-    // OK
-  } else {
-    err += "\"bufferViews\" object not found in .gltf\n";
-    return false;
+  if (numThreads <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      task(i);
+    }
+    return;
   }
 
-  scene.buffers.clear();
-  scene.bufferViews.clear();
-  scene.accessors.clear();
-  scene.meshes.clear();
-  scene.nodes.clear();
-  scene.defaultScene = "";
-
-  // 0. Parse Asset
-  if (v.contains("asset") && v.get("asset").is<picojson::object>()) {
-    const picojson::object &root = v.get("asset").get<picojson::object>();
+  // The calling thread works alongside the pool.
+  std::atomic<size_t> next(0);
+  std::function<void()> worker = [&]() {
+    for (size_t i = next++; i < count; i = next++) {
+      task(i);
+    }
+  };
 
-    ParseAsset(scene.asset, err, root);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < numThreads; i++) {
+    threads.push_back(std::thread(worker));
+  }
+  worker();
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
   }
+}
+
+bool TinyGLTFLoader::IsBinary(const unsigned char *bytes, size_t length) {
+  return (length >= 4) && (bytes[0] == 'g') && (bytes[1] == 'l') &&
+         (bytes[2] == 'T') && (bytes[3] == 'F');
+}
 
-  // 1. Parse Buffer
-  if (v.contains("buffers") && v.get("buffers").is<picojson::object>()) {
-    const picojson::object &root = v.get("buffers").get<picojson::object>();
+bool TinyGLTFLoader::LoadBinaryFromMemory(
+    Scene &scene, std::string &err, const unsigned char *bytes,
+    unsigned int length, const std::string &baseDir,
+    const std::shared_ptr<const void> &owner) {
+  // Header: magic, version, length. Version 1 follows it with
+  // contentLength and contentFormat, version 2 with a list of chunks.
+  if (length < 12 || !IsBinary(bytes, length)) {
+    err = "Invalid binary glTF header.\n";
+    return false;
+  }
 
-    picojson::object::const_iterator it(root.begin());
-    picojson::object::const_iterator itEnd(root.end());
-    for (; it != itEnd; it++) {
+  unsigned int version = ReadLittleEndianU32(bytes + 4);
+  unsigned int totalLength = ReadLittleEndianU32(bytes + 8);
+  if (totalLength > length) {
+    err = "Binary glTF is truncated.\n";
+    return false;
+  }
 
-      Buffer buffer;
-      if (!ParseBuffer(buffer, err, (it->second).get<picojson::object>(),
-                       baseDir)) {
-        return false;
-      }
+  const unsigned char *content = NULL;
+  unsigned int contentLength = 0;
+  const unsigned char *body = NULL;
+  unsigned int bodyLength = 0;
 
-      scene.buffers[it->first] = buffer;
+  if (version == 1) {
+    const unsigned int headerLength = 20;
+    if (totalLength < headerLength) {
+      err = "Invalid binary glTF header.\n";
+      return false;
     }
-  }
 
-  // 2. Parse BufferView
-  if (v.contains("bufferViews") &&
-      v.get("bufferViews").is<picojson::object>()) {
+    contentLength = ReadLittleEndianU32(bytes + 12);
+    unsigned int contentFormat = ReadLittleEndianU32(bytes + 16);
+    if (contentLength > totalLength - headerLength) {
+      err = "Binary glTF is truncated.\n";
+      return false;
+    }
 
-    const picojson::object &root = v.get("bufferViews").get<picojson::object>();
+    if (contentFormat != 0) {
+      err = "Binary glTF content is not JSON.\n";
+      return false;
+    }
 
-    picojson::object::const_iterator it(root.begin());
-    picojson::object::const_iterator itEnd(root.end());
-    for (; it != itEnd; it++) {
+    content = bytes + headerLength;
+    body = content + contentLength;
+    bodyLength = totalLength - headerLength - contentLength;
+  } else if (version == 2) {
+    // Chunk: chunkLength, chunkType, chunkData. The JSON chunk comes first
+    // and may be followed by a BIN chunk; other chunks are ignored.
+    const unsigned int kChunkJSON = 0x4E4F534A;
+    const unsigned int kChunkBIN = 0x004E4942;
+    unsigned int offset = 12;
+    for (int chunk = 0; offset < totalLength; chunk++) {
+      if (totalLength - offset < 8) {
+        err = "Binary glTF is truncated.\n";
+        return false;
+      }
 
-      BufferView bufferView;
-      if (!ParseBufferView(bufferView, err,
-                           (it->second).get<picojson::object>())) {
+      unsigned int chunkLength = ReadLittleEndianU32(bytes + offset);
+      unsigned int chunkType = ReadLittleEndianU32(bytes + offset + 4);
+      offset += 8;
+      if (chunkLength > totalLength - offset) {
+        err = "Binary glTF is truncated.\n";
         return false;
       }
 
-      scene.bufferViews[it->first] = bufferView;
+      if (chunk == 0) {
+        if (chunkType != kChunkJSON) {
+          err = "Binary glTF content is not JSON.\n";
+          return false;
+        }
+        content = bytes + offset;
+        contentLength = chunkLength;
+      } else if ((chunk == 1) && (chunkType == kChunkBIN)) {
+        body = bytes + offset;
+        bodyLength = chunkLength;
+      }
+      offset += chunkLength;
+    }
+
+    if (!content) {
+      err = "Binary glTF has no JSON chunk.\n";
+      return false;
     }
+  } else {
+    std::stringstream ss;
+    ss << "Unsupported binary glTF version " << version << "\n";
+    err = ss.str();
+    return false;
   }
 
-  // 3. Parse Accessor
-  if (v.contains("accessors") && v.get("accessors").is<picojson::object>()) {
+  binaryBody_ = body;
+  binaryBodyLength_ = bodyLength;
+  binaryOwner_ = owner;
 
-    const picojson::object &root = v.get("accessors").get<picojson::object>();
+  bool ret =
+      LoadFromString(scene, err, reinterpret_cast<const char *>(content),
+                     contentLength, baseDir);
 
-    picojson::object::const_iterator it(root.begin());
-    picojson::object::const_iterator itEnd(root.end());
-    for (; it != itEnd; it++) {
+  binaryBody_ = NULL;
+  binaryBodyLength_ = 0;
+  binaryOwner_.reset();
 
-      Accessor accessor;
-      if (!ParseAccessor(accessor, err, (it->second).get<picojson::object>())) {
-        return false;
-      }
+  return ret;
+}
 
-      scene.accessors[it->first] = accessor;
-    }
-  }
+ResourcePrefetcher::ResourcePrefetcher(const std::string &baseDir,
+                                       bool allowMapping, ResourceCache *cache)
+    : baseDir_(baseDir), allowMapping_(allowMapping), cache_(cache),
+      activeWorkers_(0), cancelled_(false) {}
 
-  // 4. Parse Mesh
-  if (v.contains("meshes") && v.get("meshes").is<picojson::object>()) {
+ResourcePrefetcher::~ResourcePrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_ = true;
+    queue_.clear();
+  }
 
-    const picojson::object &root = v.get("meshes").get<picojson::object>();
+  for (size_t i = 0; i < threads_.size(); i++) {
+    threads_[i].join();
+  }
+}
 
-    picojson::object::const_iterator it(root.begin());
-    picojson::object::const_iterator itEnd(root.end());
-    for (; it != itEnd; it++) {
+void ResourcePrefetcher::Request(const std::string &uri) {
+  if (uri.empty() || DataURIHeaderLength(uri)) {
+    return;
+  }
 
-      Mesh mesh;
-      if (!ParseMesh(mesh, err, (it->second).get<picojson::object>())) {
-        return false;
-      }
+  // Reads are mostly waiting on the disk, so a few workers are enough to keep
+  // it busy without competing with the parser for CPU time.
+  const size_t kMaxWorkers = 4;
 
-      scene.meshes[it->first] = mesh;
-    }
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::pair<EntryMap::iterator, bool> inserted =
+      entries_.insert(EntryMap::value_type(uri, Entry()));
+  if (!inserted.second) {
+    return;
   }
 
-  // 5. Parse Node
-  if (v.contains("nodes") && v.get("nodes").is<picojson::object>()) {
+  queue_.push_back(&*inserted.first);
+  if (activeWorkers_ < kMaxWorkers) {
+    activeWorkers_++;
+    threads_.push_back(std::thread(&ResourcePrefetcher::Work, this));
+  }
+}
 
-    const picojson::object &root = v.get("nodes").get<picojson::object>();
+bool ResourcePrefetcher::Wait(std::shared_ptr<MappedFile> &file,
+                              std::string &err, const std::string &uri) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  EntryMap::iterator it = entries_.find(uri);
+  if (it == entries_.end()) {
+    return false;
+  }
 
-    picojson::object::const_iterator it(root.begin());
-    picojson::object::const_iterator itEnd(root.end());
-    for (; it != itEnd; it++) {
+  const Entry &entry = it->second;
+  finished_.wait(lock, [&entry]() { return entry.done; });
 
-      Node node;
-      if (!ParseNode(node, err, (it->second).get<picojson::object>())) {
-        return false;
-      }
+  file = entry.file;
+  err += entry.err;
+  return true;
+}
 
-      scene.nodes[it->first] = node;
+void ResourcePrefetcher::Work() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!cancelled_ && !queue_.empty()) {
+    EntryMap::value_type *request = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+
+    std::shared_ptr<MappedFile> file;
+    std::string err;
+    if (LoadExternalFile(file, err, request->first, baseDir_, 0, false,
+                         allowMapping_, cache_)) {
+      // Start the disk reads here so the consumer does not stall on them.
+      file->Prefetch();
     }
+
+    lock.lock();
+    request->second.file = file;
+    request->second.err = err;
+    request->second.done = true;
+    finished_.notify_all();
   }
 
-  // 6. Parse scenes.
-  if (v.contains("scenes") && v.get("scenes").is<picojson::object>()) {
+  activeWorkers_--;
+}
 
-    const picojson::object &root = v.get("scenes").get<picojson::object>();
+bool ResourceCache::Open(std::shared_ptr<MappedFile> &file, std::string &err,
+                         const std::string &filename, bool allowMapping) {
+  Entry entry;
+  if (!GetFileStamp(filename, entry.size, entry.mtime)) {
+    // Let MappedFile report why the file cannot be opened.
+    file.reset(new MappedFile);
+    return file->Open(err, filename, allowMapping);
+  }
 
-    picojson::object::const_iterator it(root.begin());
-    picojson::object::const_iterator itEnd(root.end());
-    for (; it != itEnd; it++) {
+  const std::string path = ResolvePath(filename);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, Entry>::const_iterator it = files_.find(path);
+    if ((it != files_.end()) && (it->second.size == entry.size) &&
+        (it->second.mtime == entry.mtime)) {
+      file = it->second.file;
+      return true;
+    }
+  }
 
-      const picojson::object &o = (it->second).get<picojson::object>();
-      std::vector<std::string> nodes;
-      if (!ParseStringArrayProperty(nodes, err, o, "nodes", false)) {
-        return false;
-      }
+  // Read without holding the lock so other files can be opened meanwhile. If
+  // another thread read the same version of the file in the meantime, its
+  // copy wins; a different version replaces it. Scenes still holding a
+  // replaced copy keep it alive.
+  entry.file.reset(new MappedFile);
+  if (!entry.file->Open(err, filename, allowMapping)) {
+    return false;
+  }
 
-      scene.scenes[it->first] = nodes;
-    }
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::pair<std::map<std::string, Entry>::iterator, bool> inserted =
+      files_.insert(std::make_pair(path, entry));
+  Entry &cached = inserted.first->second;
+  if (!inserted.second &&
+      ((cached.size != entry.size) || (cached.mtime != entry.mtime))) {
+    cached = entry;
   }
+  file = cached.file;
+  return true;
+}
 
-  // 7. Parse default scenes.
-  if (v.contains("scene") && v.get("scene").is<std::string>()) {
+void ResourceCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  files_.clear();
+}
 
-    const std::string defaultScene = v.get("scene").get<std::string>();
+size_t ResourceCache::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return files_.size();
+}
 
-    scene.defaultScene = defaultScene;
-  }
+MappedFile::MappedFile() : data_(NULL), size_(0), mapped_(false) {}
 
-  // 8. Parse Material
-  if (v.contains("materials") && v.get("materials").is<picojson::object>()) {
+MappedFile::~MappedFile() { Close(); }
 
-    const picojson::object &root = v.get("materials").get<picojson::object>();
+bool MappedFile::Open(std::string &err, const std::string &filename,
+                      bool allowMapping) {
+  Close();
 
-    picojson::object::const_iterator it(root.begin());
-    picojson::object::const_iterator itEnd(root.end());
-    for (; it != itEnd; it++) {
+  if (allowMapping && Map(filename)) {
+    return true;
+  }
 
-      Material material;
-      if (!ParseMaterial(material, err, (it->second).get<picojson::object>())) {
-        return false;
-      }
+  return Read(err, filename);
+}
 
-      scene.materials[it->first] = material;
-    }
+void MappedFile::Close() {
+  if (mapped_) {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+#else
+    munmap(const_cast<unsigned char *>(data_), size_);
+#endif
   }
 
-  // 9. Parse Image
-  if (v.contains("images") && v.get("images").is<picojson::object>()) {
+  std::vector<unsigned char>().swap(buffer_);
+  data_ = NULL;
+  size_ = 0;
+  mapped_ = false;
+}
 
-    const picojson::object &root = v.get("images").get<picojson::object>();
+void MappedFile::Prefetch() const {
+  if (!mapped_) {
+    return;
+  }
 
-    picojson::object::const_iterator it(root.begin());
-    picojson::object::const_iterator itEnd(root.end());
-    for (; it != itEnd; it++) {
+#ifdef _WIN32
+  // PrefetchVirtualMemory only exists on Windows 8 and later.
+  struct MemoryRange {
+    PVOID VirtualAddress;
+    SIZE_T NumberOfBytes;
+  };
+  typedef BOOL(WINAPI * PrefetchFunc)(HANDLE, ULONG_PTR, MemoryRange *, ULONG);
+  static const PrefetchFunc prefetch = reinterpret_cast<PrefetchFunc>(
+      GetProcAddress(GetModuleHandleA("kernel32.dll"), "PrefetchVirtualMemory"));
+  if (prefetch) {
+    MemoryRange range;
+    range.VirtualAddress = const_cast<unsigned char *>(data_);
+    range.NumberOfBytes = size_;
+    prefetch(GetCurrentProcess(), 1, &range, 0);
+  }
+#else
+  madvise(const_cast<unsigned char *>(data_), size_, MADV_WILLNEED);
+#endif
+}
 
-      Image image;
-      if (!ParseImage(image, err, (it->second).get<picojson::object>(),
-                      baseDir)) {
-        return false;
-      }
+bool MappedFile::Map(const std::string &filename) {
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
 
-      scene.images[it->first] = image;
-    }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+    CloseHandle(file);
+    return false;
   }
 
-  // 9. Parse Texture
-  if (v.contains("textures") && v.get("textures").is<picojson::object>()) {
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (!mapping) {
+    return false;
+  }
 
-    const picojson::object &root = v.get("textures").get<picojson::object>();
+  // The view keeps the mapping object alive after its handle is closed.
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!view) {
+    return false;
+  }
 
-    picojson::object::const_iterator it(root.begin());
-    picojson::object::const_iterator itEnd(root.end());
-    for (; it != itEnd; it++) {
+  data_ = static_cast<const unsigned char *>(view);
+  size_ = static_cast<size_t>(fileSize.QuadPart);
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
 
-      Texture texture;
-      if (!ParseTexture(texture, err, (it->second).get<picojson::object>(),
-                        baseDir)) {
-        return false;
-      }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return false;
+  }
 
-      scene.textures[it->first] = texture;
-    }
+  // The mapping stays valid after the descriptor is closed.
+  void *view = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ,
+                    MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (view == MAP_FAILED) {
+    return false;
   }
 
+  data_ = static_cast<const unsigned char *>(view);
+  size_ = static_cast<size_t>(st.st_size);
+#endif
+
+  mapped_ = true;
   return true;
 }
 
-bool TinyGLTFLoader::LoadFromFile(Scene &scene, std::string &err,
-                                  const std::string &filename) {
-  std::stringstream ss;
-
-  std::ifstream f(filename.c_str());
+bool MappedFile::Read(std::string &err, const std::string &filename) {
+  std::ifstream f(filename.c_str(), std::ifstream::binary);
   if (!f) {
-    ss << "Failed to open file: " << filename << std::endl;
-    err = ss.str();
+    err += "Failed to open file: " + filename + "\n";
     return false;
   }
 
   f.seekg(0, f.end);
-  size_t sz = f.tellg();
-  std::vector<char> buf(sz);
-
+  std::streamoff end = f.tellg();
   f.seekg(0, f.beg);
-  f.read(&buf.at(0), sz);
+  if (!f || (end < 0)) {
+    err += "Failed to get the size of file: " + filename + "\n";
+    return false;
+  }
+  // Directories open and report a bogus size, but nothing can be read.
+  if ((end > 0) && (f.peek() == std::ifstream::traits_type::eof())) {
+    err += "Failed to read file: " + filename + "\n";
+    return false;
+  }
+
+  size_t sz = static_cast<size_t>(end);
+  buffer_.resize(sz);
+  if (sz > 0) {
+    f.read(reinterpret_cast<char *>(&buffer_.at(0)), sz);
+  }
+  if (!f) {
+    std::vector<unsigned char>().swap(buffer_);
+    err += "Failed to read file: " + filename + "\n";
+    return false;
+  }
   f.close();
 
-  std::string basedir = GetBaseDir(filename);
+  data_ = buffer_.empty() ? NULL : &buffer_.at(0);
+  size_ = sz;
+  return true;
+}
+
+void tinygltf::GatherFloats(float *out, const unsigned char *data,
+                            size_t count, size_t stride, int components) {
+  size_t done = 0;
+#if TINYGLTF_SIMD_X86
+  if (components >= 2) {
+    const CpuFeatures &cpu = GetCpuFeatures();
+    if (cpu.avx2) {
+      done = GatherFloatsAVX2(out, data, count, stride, components);
+    }
+    if (cpu.sse2) {
+      done += GatherFloatsSSE2(out + done * components, data + done * stride,
+                               count - done, stride, components);
+    }
+  }
+#endif
+  GatherFloatsScalar(out + done * components, data + done * stride,
+                     count - done, stride, components);
+}
+
+bool tinygltf::DecodeNormalized(float *out, const unsigned char *data,
+                                size_t count, size_t stride, int components,
+                                int componentType) {
+  switch (componentType) {
+  case TINYGLTF_COMPONENT_TYPE_BYTE:
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+  case TINYGLTF_COMPONENT_TYPE_SHORT:
+  case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+    break;
+  default:
+    return false;
+  }
+  if ((components < 1) || (components > 4)) {
+    return false;
+  }
 
-  bool ret = LoadFromString(scene, err, &buf.at(0), buf.size(), basedir);
+  const size_t elementSize =
+      components * GetComponentSizeInBytes(componentType);
+  if (stride == elementSize) {
+    DecodeNormalizedRun(out, data, count * components, componentType);
+    return true;
+  }
 
-  return ret;
+  // Interleaved elements are packed a block at a time first, so the kernels
+  // always see whole vectors of components.
+  unsigned char block[4096];
+  const size_t blockCount = sizeof(block) / elementSize;
+  for (size_t i = 0; i < count; i += blockCount) {
+    const size_t n = (count - i < blockCount) ? count - i : blockCount;
+    const unsigned char *first = data + i * stride;
+    switch (elementSize) {
+    case 1: PackElements<1>(block, first, n, stride); break;
+    case 2: PackElements<2>(block, first, n, stride); break;
+    case 3: PackElements<3>(block, first, n, stride); break;
+    case 4: PackElements<4>(block, first, n, stride); break;
+    case 6: PackElements<6>(block, first, n, stride); break;
+    case 8: PackElements<8>(block, first, n, stride); break;
+    default: return false;
+    }
+    DecodeNormalizedRun(out + i * components, block, n * components,
+                        componentType);
+  }
+  return true;
 }
 
 #endif // TINYGLTF_LOADER_IMPLEMENTATION
@@ -43,6 +43,11 @@ private:
 	/// Bound to the import button's OnClicked event which expects an FReply; OpenImportWindow() itself is used for FGLTFLoaderCommands which expects a void.
 	FReply OpenImportWindowDelegateFunc() { OpenImportWindow(); return FReply::Handled(); }
 
+	/// Bound to the preview button; lets the user pick a file and shows what it contains without importing it.
+	FReply PreviewFileDelegateFunc();
+	/// Bound to the text block showing the result of the last preview.
+	FText GetPreviewText() const { return PreviewText; }
+
 	/// @name UI Setters
 	///@{
 	/// These functions are bound to the UI elements when they are created and called to update the options' data when the user modifies the values.
@@ -76,4 +81,7 @@ private:
 
 	/// <B>(Boilerplate)</B> Used to link with FGLTFLoaderCommands.
 	TSharedPtr<class FUICommandList> PluginCommands;
+
+	/// Summary of the last previewed file.
+	FText PreviewText;
 };
\ No newline at end of file